@@ -0,0 +1,229 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/window.h>
+#include <mikroplot/mapped.h>
+#include <mikroplot/csv.h>
+#include <mikroplot/history.h>
+#include <mikroplot/histogram.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+namespace {
+	using namespace mikroplot;
+
+	double secondsSince(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Writes rows of (x,y) float32 pairs.
+	void writeRawFile(const std::string& fileName, std::size_t numRows) {
+		std::ofstream f(fileName, std::ios::binary);
+		std::vector<float> row(2);
+		for(std::size_t i=0; i<numRows; ++i) {
+			row[0] = float(i) / float(numRows);
+			row[1] = std::sin(40.0f*row[0]) + 0.1f*std::sin(float(i));
+			f.write((const char*)row.data(), row.size()*sizeof(float));
+		}
+	}
+
+	// Time to first frame: file read into std::vector<vec2> vs. memory mapped column views.
+	void benchMappedLoading(Window& window, std::size_t numRows) {
+		const std::string fileName = "mikroplot_bench.f32";
+		writeRawFile(fileName, numRows);
+		window.setScreen(0, 1, -1.5f, 1.5f);
+		window.setDecimation(Decimation::M4);
+		window.update();
+
+		auto start = std::chrono::steady_clock::now();
+		{
+			std::ifstream f(fileName, std::ios::binary);
+			std::vector<vec2> points(numRows);
+			f.read((char*)points.data(), points.size()*sizeof(vec2));
+			window.drawLines(points);
+			window.update();
+		}
+		double readSeconds = secondsSince(start);
+
+		start = std::chrono::steady_clock::now();
+		{
+			auto file = ArrayFile::openRaw(fileName, DataType::FLOAT32, 2);
+			file->advise(AccessPattern::SEQUENTIAL);
+			window.drawLines(file->column(0), file->column(1));
+			window.update();
+		}
+		double mappedSeconds = secondsSince(start);
+
+		printf("Time to first frame, %zu rows (%.1f MB):\n", numRows, double(numRows*2*sizeof(float)) / (1024.0*1024.0));
+		printf("  read:   %8.2f ms\n", readSeconds*1000.0);
+		printf("  mapped: %8.2f ms\n", mappedSeconds*1000.0);
+		std::remove(fileName.c_str());
+	}
+
+	// CSV parsing throughput and time to first frame.
+	void benchCsvLoading(Window& window, std::size_t numRows) {
+		const std::string fileName = "mikroplot_bench.csv";
+		{
+			std::ofstream f(fileName);
+			f << "time,value,noise,label\n";
+			char line[128];
+			for(std::size_t i=0; i<numRows; ++i) {
+				float t = float(i) / float(numRows);
+				int n = snprintf(line, sizeof(line), "%.7f,%.6f,%.4e,%d\n", t, std::sin(40.0f*t), 0.1f*std::sin(float(i)), int(i%16));
+				f.write(line, n);
+			}
+		}
+		window.setScreen(0, 1, -1.5f, 1.5f);
+		window.setDecimation(Decimation::M4);
+		window.update();
+
+		auto start = std::chrono::steady_clock::now();
+		CsvOptions options;
+		options.columns = {"time", "value"};
+		auto table = CsvTable::load(fileName, options);
+		double parseSeconds = secondsSince(start);
+		window.drawLines(table.column("time"), table.column("value"));
+		window.update();
+		double firstFrameSeconds = secondsSince(start);
+
+		std::ifstream f(fileName, std::ios::binary | std::ios::ate);
+		double gigaBytes = double(f.tellg()) / 1e9;
+		printf("CSV loading, %zu rows (%.2f GB), %zu threads:\n", table.getNumRows(), gigaBytes, JobSystem::get().getNumThreads());
+		printf("  parse:       %8.2f ms (%.2f GB/s)\n", parseSeconds*1000.0, gigaBytes / parseSeconds);
+		printf("  first frame: %8.2f ms\n", firstFrameSeconds*1000.0);
+		f.close();
+		std::remove(fileName.c_str());
+	}
+
+	// Compressed history: memory per sample and decode throughput of the full range and of a zoomed view.
+	void benchHistory(Window& window, std::size_t numRows) {
+		// Telemetry like series: 100 ms interval with jitter, values quantized to sensor resolution.
+		SeriesHistory history(0.001);
+		int64_t timestamp = 0;
+		for(std::size_t i=0; i<numRows; ++i) {
+			timestamp += 100 + ((i % 7) == 0 ? int64_t(i % 3) - 1 : 0);
+			float value = std::round(1000.0f * std::sin(0.0001f*float(i))) / 100.0f;
+			history.append(timestamp, value);
+		}
+		const double rawBytes = double(numRows*sizeof(vec2));
+		printf("Compressed history, %zu samples, %zu blocks:\n", history.getNumSamples(), history.getNumBlocks());
+		printf("  size:   %8.2f MB (%.2f bytes/sample, raw vec2 %.1f MB)\n", history.getCompressedSize() / (1024.0*1024.0), history.getBytesPerSample(), rawBytes / (1024.0*1024.0));
+
+		const double end = double(timestamp) * 0.001;
+		auto start = std::chrono::steady_clock::now();
+		auto points = history.query(0.0, end);
+		double seconds = secondsSince(start);
+		printf("  decode: %8.2f ms (%.1f Msamples/s)\n", seconds*1000.0, double(points.size()) / seconds / 1e6);
+
+		window.setScreen(float(0.9*end), float(end), -11.0f, 11.0f);
+		window.setDecimation(Decimation::M4);
+		start = std::chrono::steady_clock::now();
+		window.drawHistory(history);
+		window.update();
+		printf("  frame (last 10%%, cold): %8.2f ms\n", secondsSince(start)*1000.0);
+		start = std::chrono::steady_clock::now();
+		window.drawHistory(history);
+		window.update();
+		printf("  frame (last 10%%, cached): %8.2f ms\n", secondsSince(start)*1000.0);
+	}
+
+	// Histogram binning throughput on CPU and GPU. Values are streamed in chunks of one reused buffer.
+	void benchHistogram(Window& window, std::size_t numValues) {
+		const std::size_t CHUNK_SIZE = std::size_t(1) << 24;
+		std::vector<float> chunk(std::min(numValues, CHUNK_SIZE));
+		for(std::size_t i=0; i<chunk.size(); ++i) {
+			chunk[i] = std::sin(float(i)) * std::sin(0.001f*float(i));
+		}
+		auto bin = [&](auto add) {
+			auto start = std::chrono::steady_clock::now();
+			for(std::size_t begin=0; begin<numValues; begin += chunk.size()) {
+				add(chunk.data(), std::min(chunk.size(), numValues - begin));
+			}
+			return secondsSince(start);
+		};
+		Histogram cpu(-1.0f, 1.0f, 256);
+		double cpuSeconds = bin([&](const float* values, std::size_t count) { cpu.add(values, count); });
+		Histogram gpu(-1.0f, 1.0f, 256);
+		double gpuSeconds = bin([&](const float* values, std::size_t count) { window.binHistogram(gpu, values, count); });
+
+		printf("Histogram, %zu values, 256 bins:\n", numValues);
+		printf("  cpu: %8.2f ms (%.2f Gvalues/s)\n", cpuSeconds*1000.0, double(numValues) / cpuSeconds / 1e9);
+		printf("  gpu: %8.2f ms (%.2f Gvalues/s)\n", gpuSeconds*1000.0, double(numValues) / gpuSeconds / 1e9);
+		window.setScreen(-1.0f, 1.0f, 0.0f, 1.5f);
+		window.drawHistogram(cpu, 13, true);
+		window.update();
+	}
+
+	void benchDensity(Window& window, std::size_t numPoints) {
+		std::vector<vec2> points(numPoints);
+		for(std::size_t i=0; i<numPoints; ++i) {
+			const float t = float(i) / float(numPoints);
+			points[i] = vec2(std::sin(float(i)) * t, std::cos(1.618f*float(i)) * std::sqrt(t));
+		}
+		window.setScreen(-1.0f, 1.0f, -1.0f, 1.0f);
+		auto draw = [&](bool useGPU) {
+			DensityOptions options;
+			options.useGPU = useGPU;
+			auto start = std::chrono::steady_clock::now();
+			window.drawDensity(points, options);
+			window.update();
+			return secondsSince(start);
+		};
+		double cpuSeconds = draw(false);
+		double gpuSeconds = draw(true);
+		printf("Density, %zu points:\n", numPoints);
+		printf("  cpu: %8.2f ms (%.2f Gpoints/s)\n", cpuSeconds*1000.0, double(numPoints) / cpuSeconds / 1e9);
+		printf("  gpu: %8.2f ms (%.2f Gpoints/s)\n", gpuSeconds*1000.0, double(numPoints) / gpuSeconds / 1e9);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	using namespace mikroplot;
+	const std::string bench = argc > 1 ? argv[1] : "all";
+	const std::size_t numRows = argc > 2 ? std::strtoull(argv[2], 0, 10) : 10000000;
+
+	Window window(512, 512, "Mikroplot benchmarks");
+	if(bench == "all" || bench == "mapped") {
+		benchMappedLoading(window, numRows);
+	}
+	if(bench == "all" || bench == "csv") {
+		benchCsvLoading(window, numRows);
+	}
+	if(bench == "all" || bench == "history") {
+		benchHistory(window, numRows);
+	}
+	if(bench == "all" || bench == "histogram") {
+		benchHistogram(window, numRows);
+	}
+	if(bench == "all" || bench == "density") {
+		benchDensity(window, numRows);
+	}
+	return 0;
+}
@@ -26,6 +26,7 @@
 //// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
 #include <mikroplot/window.h>
 #include <random>
+#include <cmath>
 
 
 int main() {
@@ -52,6 +53,14 @@ int main() {
 		pixels[y][x] = i;
 	}
 
+	// Create window. GPU state used by the scenes is declared after it, so it is destroyed before the GL context.
+	Window window(512, 512, "Mikroplot demo");
+
+	// Heat equation state, stays on the GPU.
+	std::unique_ptr<Feedback> heat;
+	// Mandelbrot tiles accumulated over frames.
+	ProgressiveShade mandelbrot;
+
 	auto renderScene = [&](Window& window, int scene, float time) {
 		if(scene==7){
 			window.setTitle("Draw coordinate axis (-10, 10)");
@@ -79,6 +88,8 @@ int main() {
 				x = 0.5f*x;
 				return -0.8f*x*x*x + 1.3f*x*x;
 			}, 15, 4);
+			// Family of 8 curves evaluated on GPU
+			window.drawFunctionGLSL("sin(x + t + 0.25*instance)", {Constant("t",{time})}, 13, 1, 8);
 		} else if(scene==3) {
 			window.setTitle("Draw circle shading (-3, 3)");
 			window.setScreen(-3,3,-3,3);
@@ -124,11 +135,11 @@ int main() {
 				"}"
 			);
 		} else if(scene==8){
-			window.setTitle("Mandelbrot");
+			window.setTitle("Mandelbrot, progressive " + std::to_string(int(100*mandelbrot.getProgress())) + "%");
 			window.setClearColor();
 			window.setScreen(-2,1,-1.5,1.5);
 			window.drawAxis();
-			window.shade(shaders::mandelbrot, shader_funcs::mandelbrot);
+			window.shade(mandelbrot, {}, shaders::mandelbrot, shader_funcs::mandelbrot);
 		} else if(scene==9){
 			window.setTitle("Draw Sprites");
 			window.setClearColor();
@@ -153,6 +164,19 @@ int main() {
 			transform[3][0] = -3;
 			transform[3][1] = 2;
 			window.drawSprite(transform,pixels,{Constant("t",{time})},"color = vec4(max(color.r,abs(sin(10*t))), color.g, color.b, color.a);");
+		} else if(scene==10){
+			window.setTitle("Simulate heat equation, 8 steps per frame");
+			window.setClearColor();
+			window.setScreen(-8,8,-8,8);
+			if(!heat) {
+				heat = std::make_unique<Feedback>(256, 256);
+			}
+			window.simulate(*heat, 8, {Constant("source",{128.0f + 80.0f*std::cos(time), 128.0f + 80.0f*std::sin(time)})},
+				"float laplacian = state(-1,0).r + state(1,0).r + state(0,-1).r + state(0,1).r - 4.0*color.r;"
+				"color.r += 0.2*laplacian;"
+				"if(distance(vec2(cell), source) < 4.0) color.r = 1.0;"
+			);
+			window.drawFeedback(*heat, ValueRange());
 		}
 		if(window.getKeyPressed(KeyCodes::KEY_SPACE)){
 			try {
@@ -165,10 +189,8 @@ int main() {
 		}
 	};
 
-	// Create window and run it.
-	Window window(512, 512, "Mikroplot demo");
-
-	window.runClips(renderScene, 10, 5.0f, 2);
+	// Run window.
+	window.runClips(renderScene, 11, 5.0f, 2);
 
 	return 0;
 }
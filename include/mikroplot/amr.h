@@ -0,0 +1,113 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/range.h>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <stdint.h>
+
+namespace mikroplot {
+
+	class Texture;
+	class Window;
+
+	///
+	/// \brief Block of values at one refinement level. Row 0 is at the top of the patch.
+	struct AmrPatch {
+		float              left = 0;
+		float              right = 1;
+		float              bottom = 0;
+		float              top = 1;
+		int                level = 0;
+		std::size_t        width = 0;
+		std::size_t        height = 0;
+		std::vector<float> values;
+	};
+
+	///
+	/// \brief Block-structured adaptive mesh refinement data for Window::drawAmr.
+	///
+	/// Patches are packed to float texture atlas, so memory use is the sum of the patch sizes instead of a dense grid
+	/// at the finest level. The atlas is split to pages of at most GL_MAX_TEXTURE_SIZE, queried when first drawn.
+	/// Drawing throws std::runtime_error, if a single patch is larger than that. Patches are drawn coarse levels first, so each pixel shows the finest
+	/// patch covering it. NaN values are transparent and show the coarser level below.
+	///
+	class AmrField {
+	public:
+		AmrField();
+		~AmrField();
+
+		// Returns index of the added patch.
+		std::size_t addPatch(const AmrPatch& patch);
+		// Replaces values of a patch. Size of the patch does not change. Only changed patches are uploaded.
+		void setValues(std::size_t patch, const std::vector<float>& values);
+		void clear();
+
+		const std::vector<AmrPatch>& getPatches() const { return m_patches; }
+
+		///
+		/// \brief Returns indices of patches overlapping view in drawing order.
+		///
+		/// Patches, which fit inside minPixels x minPixels pixels, are culled: the coarser patch below is drawn instead.
+		std::vector<std::size_t> visiblePatches(float left, float right, float bottom, float top, float pixelsPerUnitX, float pixelsPerUnitY, float minPixels = 1.0f) const;
+
+	private:
+		friend class Window;
+		AmrField(const AmrField&) = delete;
+		AmrField& operator=(const AmrField&) = delete;
+
+		struct Placement {
+			int page;
+			int x;
+			int y;
+		};
+		// Packs patches to pages of at most maxSize x maxSize values.
+		void pack(int maxSize);
+		// Patch values in atlas layout, page after page. Unused texels are NaN.
+		std::vector<float> atlasValues() const;
+
+		std::vector<AmrPatch>    m_patches;
+		std::vector<std::size_t> m_drawOrder;	// Patches sorted by level.
+		std::vector<Placement>   m_placements;
+		std::vector<char>        m_dirty;	// Patches changed by setValues since the last upload.
+		int                      m_atlasWidth;
+		int                      m_atlasHeight;	// Size of each page.
+		int                      m_numPages;
+		bool                     m_packed;
+		uint64_t                 m_version;
+
+		// GPU state, managed by Window.
+		std::vector<std::shared_ptr<Texture> > m_textures;	// One per page.
+		uint64_t                 m_uploadedVersion;
+		RangeOptions             m_rangeOptions;
+		ValueRange               m_range;
+		uint32_t                 m_vao;
+		uint32_t                 m_vertexBuffer;
+	};
+
+}
@@ -0,0 +1,58 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/window.h>
+#include <vector>
+#include <utility>
+#include <stdint.h>
+
+namespace mikroplot {
+
+	namespace clip {
+		// Point is inside the rectangle, when its outcode is 0.
+		enum Outcode : uint8_t {
+			LEFT   = 1,
+			RIGHT  = 2,
+			BOTTOM = 4,
+			TOP    = 8
+		};
+
+		// Computes Cohen-Sutherland outcodes of points against rectangle (SSE2, in parallel for large arrays).
+		void outcodes(const vec2* points, std::size_t count, float left, float right, float bottom, float top, uint8_t* codes);
+
+		enum class Primitive { POINTS, LINES, LINE_STRIP };
+
+		///
+		/// \brief Returns visible runs [begin,end) of points.
+		///
+		/// Line strips: runs of consecutive segments, which are not trivially outside the rectangle.
+		/// Line lists: runs of such point pairs. Points: runs of points inside the rectangle.
+		/// Runs are conservative: a segment crossing a rectangle corner region may be kept.
+		std::vector< std::pair<std::size_t, std::size_t> > visibleRuns(const vec2* points, std::size_t count, Primitive primitive, float left, float right, float bottom, float top);
+	}
+
+}
@@ -0,0 +1,105 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <vector>
+
+namespace mikroplot {
+
+	enum class DataType {
+		FLOAT32,
+		FLOAT64
+	};
+
+	///
+	/// \brief Typed zero-copy view to strided values.
+	template<typename T>
+	struct StridedView {
+		const uint8_t* data;
+		std::size_t    count;
+		std::size_t    stride;	// Distance of values in bytes.
+
+		T operator[](std::size_t i) const {
+			T value;
+			memcpy(&value, data + i*stride, sizeof(T));
+			return value;
+		}
+		std::size_t size() const { return count; }
+	};
+
+	///
+	/// \brief Zero-copy view to a column of float32 or float64 values.
+	///
+	/// Column can point to std::vector, to a column of memory mapped file etc. Viewed memory must stay valid
+	/// as long as the view is used.
+	struct ColumnView {
+		const uint8_t* data = 0;
+		std::size_t    count = 0;
+		std::size_t    stride = 0;
+		DataType       type = DataType::FLOAT32;
+
+		ColumnView() = default;
+		ColumnView(const uint8_t* d, std::size_t n, std::size_t s, DataType t)
+			: data(d), count(n), stride(s), type(t) {
+		}
+		ColumnView(const float* values, std::size_t n)
+			: ColumnView((const uint8_t*)values, n, sizeof(float), DataType::FLOAT32) {
+		}
+		ColumnView(const double* values, std::size_t n)
+			: ColumnView((const uint8_t*)values, n, sizeof(double), DataType::FLOAT64) {
+		}
+		ColumnView(const std::vector<float>& values)
+			: ColumnView(values.data(), values.size()) {
+		}
+
+		std::size_t size() const { return count; }
+
+		float operator[](std::size_t i) const {
+			if(type == DataType::FLOAT32) {
+				return StridedView<float>{data, count, stride}[i];
+			}
+			return float(StridedView<double>{data, count, stride}[i]);
+		}
+
+		// Returns pointer to values, if the column is contiguous float32 array. Otherwise 0.
+		const float* floats() const {
+			return type == DataType::FLOAT32 && stride == sizeof(float) ? (const float*)data : 0;
+		}
+
+		// Calls f with StridedView<float> or StridedView<double>, so that the type is resolved once per call, not per value.
+		template<typename F>
+		auto visit(F f) const {
+			if(type == DataType::FLOAT32) {
+				return f(StridedView<float>{data, count, stride});
+			}
+			return f(StridedView<double>{data, count, stride});
+		}
+	};
+
+}
@@ -0,0 +1,89 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/window.h>
+#include <vector>
+#include <stdint.h>
+
+namespace mikroplot {
+
+	///
+	/// \brief Iso-lines of a HeatMap extracted with parallel marching squares.
+	///
+	/// The field is split to tiles, which are contoured in parallel for all levels. Segments are linked to
+	/// polylines inside each tile and the tile polylines are stitched across tile boundaries by global edge ids.
+	/// Results are cached: update() recomputes only when the field or levels have changed. Window::drawContours
+	/// uploads segments to the GPU only after they have been recomputed.
+	///
+	/// Coordinates are in grid units: x is column and y is row of the field.
+	///
+	class Contours {
+	public:
+		explicit Contours(const std::vector<float>& levels, std::size_t tileSize = 128);
+		~Contours();
+
+		///
+		/// \brief Extracts contours, unless field and levels are unchanged since the last call. Returns true, if recomputed.
+		///
+		/// Changes of the field are found by hashing the whole field, which is a parallel pass over all values on every
+		/// call. With hashField false the field is assumed unchanged until invalidate() or a size change, and the pass
+		/// is skipped.
+		bool update(const HeatMap& field, bool hashField = true);
+		void setLevels(const std::vector<float>& levels);
+		void invalidate() { m_valid = false; }
+
+		const std::vector<float>& getLevels() const { return m_levels; }
+		std::size_t getWidth() const { return m_width; }
+		std::size_t getHeight() const { return m_height; }
+		// Polylines of level. Closed loops end with their first point.
+		const std::vector< std::vector<vec2> >& getPolylines(std::size_t level) const { return m_polylines[level]; }
+		// Segments of level as line list (two points per segment), for drawing with one call.
+		const std::vector<vec2>& getSegments(std::size_t level) const { return m_segments[level]; }
+
+	private:
+		friend class Window;
+		Contours(const Contours&) = delete;
+		Contours& operator=(const Contours&) = delete;
+
+		std::vector<float>                              m_levels;
+		std::size_t                                     m_tileSize;
+		std::size_t                                     m_width;
+		std::size_t                                     m_height;
+		uint64_t                                        m_checksum;
+		bool                                            m_valid;
+		std::vector< std::vector< std::vector<vec2> > > m_polylines;
+		std::vector< std::vector<vec2> >                m_segments;
+		uint64_t                                        m_version;	// Incremented, when contours are recomputed.
+
+		// GPU state, managed by Window.
+		uint64_t                                        m_uploadedVersion;
+		std::vector<std::size_t>                        m_levelStart;	// First vertex of each level in m_vertexBuffer and the end.
+		uint32_t                                        m_vao;
+		uint32_t                                        m_vertexBuffer;
+	};
+
+}
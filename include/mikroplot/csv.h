@@ -0,0 +1,68 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/column.h>
+#include <string>
+#include <vector>
+
+namespace mikroplot {
+
+	struct CsvOptions {
+		char                     delimiter = ',';
+		bool                     hasHeader = true;	// First line contains column names.
+		std::vector<std::string> columns;			// Names of columns to load. Empty loads all columns.
+		std::size_t              chunkSize = 4 << 20;	// Bytes parsed by a single job.
+	};
+
+	///
+	/// \brief Numeric CSV table loaded into contiguous float columns.
+	///
+	/// Input is memory mapped and split into chunks at line boundaries. Chunks are parsed in parallel:
+	/// delimiters are located with SIMD scanning and values are parsed with std::from_chars.
+	/// Fields, which are empty or not numbers, are NaN.
+	///
+	class CsvTable {
+	public:
+		// Loads file. Throws std::runtime_error, if the file can not be read or a selected column does not exist.
+		static CsvTable load(const std::string& fileName, const CsvOptions& options = CsvOptions());
+		// Parses CSV text.
+		static CsvTable parse(const char* text, std::size_t size, const CsvOptions& options = CsvOptions());
+
+		std::size_t getNumRows() const { return m_columns.empty() ? 0 : m_columns[0].size(); }
+		std::size_t getNumColumns() const { return m_columns.size(); }
+		const std::vector<std::string>& getNames() const { return m_names; }
+
+		const std::vector<float>& column(std::size_t index) const { return m_columns[index]; }
+		// Returns column by name. Throws std::runtime_error, if there is no such column.
+		const std::vector<float>& column(const std::string& name) const;
+
+	private:
+		std::vector<std::string>          m_names;
+		std::vector< std::vector<float> > m_columns;
+	};
+
+}
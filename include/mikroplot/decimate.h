@@ -0,0 +1,54 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/window.h>
+#include <mikroplot/column.h>
+#include <vector>
+
+namespace mikroplot {
+
+	namespace decimate {
+		///
+		/// \brief M4 decimation: first, min, max and last point of each pixel column.
+		///
+		/// Points must be sorted by x. Line strip drawn from the result is pixel identical with the line strip
+		/// drawn from all points. Points outside [left,right] are dropped, except the closest point on both sides.
+		std::vector<vec2> m4(const vec2* points, std::size_t count, float left, float right, std::size_t columns);
+		std::vector<vec2> m4(const ColumnView& x, const ColumnView& y, float left, float right, std::size_t columns);
+
+		///
+		/// \brief Largest-Triangle-Three-Buckets downsampling to threshold points.
+		///
+		/// Points must be sorted by x. First and last points are always kept.
+		std::vector<vec2> lttb(const vec2* points, std::size_t count, std::size_t threshold);
+		std::vector<vec2> lttb(const ColumnView& x, const ColumnView& y, std::size_t threshold);
+		// Same for points inside [left,right] and the closest point outside on both sides.
+		std::vector<vec2> lttb(const vec2* points, std::size_t count, float left, float right, std::size_t threshold);
+		std::vector<vec2> lttb(const ColumnView& x, const ColumnView& y, float left, float right, std::size_t threshold);
+	}
+
+}
@@ -0,0 +1,59 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/column.h>
+#include <cstddef>
+
+namespace mikroplot {
+
+	struct vec2;
+
+	/// \brief Mapping of point counts to colors.
+	enum class DensityScale {
+		LINEAR,
+		LOG,
+		EQUALIZE
+	};
+
+	struct DensityOptions {
+		DensityScale scale = DensityScale::LOG;
+		// Splat points with additive blending to float framebuffer. Otherwise points are binned on the CPU in parallel.
+		bool         useGPU = true;
+		// Points per upload: point data need not fit to GPU memory.
+		std::size_t  chunkSize = std::size_t(1) << 22;
+	};
+
+	namespace density {
+		///
+		/// \brief Adds number of points in each pixel of width x height grid over view to counts in parallel.
+		///
+		/// Row 0 is the top of the view. Points outside the view and NaN points are skipped.
+		void bin(const vec2* points, std::size_t count, float left, float right, float bottom, float top, int width, int height, float* counts);
+		void bin(const ColumnView& x, const ColumnView& y, float left, float right, float bottom, float top, int width, int height, float* counts);
+	}
+
+}
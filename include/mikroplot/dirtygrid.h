@@ -0,0 +1,114 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/window.h>
+#include <vector>
+#include <memory>
+#include <stdint.h>
+#include <assert.h>
+
+namespace mikroplot {
+
+	class Texture;
+
+	///
+	/// \brief Palette indexed pixel grid, which keeps track of modified cells.
+	///
+	/// Window::drawPixels(DirtyGrid&) keeps the grid in a persistent texture and uploads only
+	/// the rows and columns, which have been changed after the previous draw.
+	///
+	class DirtyGrid {
+	public:
+		struct Span {
+			uint32_t begin;
+			uint32_t end;	// Exclusive. Span is empty, if begin >= end.
+		};
+
+		DirtyGrid(std::size_t width, std::size_t height, int value = 0);
+		explicit DirtyGrid(const Grid& grid);
+		~DirtyGrid();
+
+		std::size_t getWidth() const { return m_width; }
+		std::size_t getHeight() const { return m_height; }
+
+		int get(std::size_t x, std::size_t y) const {
+			assert(x < m_width && y < m_height);
+			return m_cells[y*m_width + x];
+		}
+
+		void set(std::size_t x, std::size_t y, int value) {
+			assert(x < m_width && y < m_height);
+			int& cell = m_cells[y*m_width + x];
+			if(cell != value) {
+				cell = value;
+				markDirty(x, y, 1, 1);
+			}
+		}
+
+		// Read only access to a row.
+		const int* row(std::size_t y) const {
+			assert(y < m_height);
+			return &m_cells[y*m_width];
+		}
+
+		// Writable access to a row. Whole row is marked as dirty.
+		int* editRow(std::size_t y) {
+			markDirty(0, y, m_width, 1);
+			return &m_cells[y*m_width];
+		}
+
+		// Sets rectangle to given value.
+		void fill(std::size_t x, std::size_t y, std::size_t width, std::size_t height, int value);
+
+		// Copies grid content. Rows are compared against current content and only changed spans are marked as dirty.
+		void assign(const Grid& grid);
+
+		void markDirty(std::size_t x, std::size_t y, std::size_t width, std::size_t height);
+		void markAllDirty();
+		bool isDirty() const { return m_dirtyRowBegin < m_dirtyRowEnd; }
+		// Dirty span of row y.
+		Span getDirtySpan(std::size_t y) const { return m_rowSpans[y]; }
+
+	private:
+		friend class Window;
+		DirtyGrid(const DirtyGrid&) = delete;
+		DirtyGrid& operator=(const DirtyGrid&) = delete;
+		void clearDirty();
+
+		std::size_t					m_width;
+		std::size_t					m_height;
+		std::vector<int>			m_cells;
+		std::vector<Span>			m_rowSpans;
+		std::size_t					m_dirtyRowBegin;
+		std::size_t					m_dirtyRowEnd;
+		// Upload state, managed by Window.
+		std::shared_ptr<Texture>	m_texture;
+		const Window*				m_owner;
+		uint32_t					m_paletteVersion;
+	};
+
+}
@@ -0,0 +1,91 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <stdint.h>
+
+namespace mikroplot {
+
+	class Texture;
+	class FrameBuffer;
+	class Window;
+
+	///
+	/// \brief GPU resident state of a simulation for Window::simulate.
+	///
+	/// State is a float texture of width x height cells with 1, 2 or 4 channels. Each step renders the next state
+	/// to a second framebuffer from the previous one and swaps them, so the state stays on the GPU between
+	/// frames. Row 0 is at the top of the screen. With wrap, neighbors of edge cells are on the opposite edge,
+	/// otherwise edge cells repeat.
+	///
+	class Feedback {
+	public:
+		Feedback(int width, int height, int channels = 1, bool wrap = true);
+		~Feedback();
+
+		// Sets state of all cells, width*height*channels values. Uploaded before the next step or draw.
+		void setState(const std::vector<float>& state);
+
+		int getWidth() const { return m_width; }
+		int getHeight() const { return m_height; }
+		int getChannels() const { return m_channels; }
+		// Returns number of steps simulated.
+		uint64_t getSteps() const { return m_steps; }
+
+		///
+		/// \brief Starts copying the current state to CPU memory without waiting for the GPU.
+		///
+		/// Returns false, if nothing has been simulated or drawn yet, or the previous readback has not been collected.
+		bool requestReadback();
+		// Returns true and the state of the latest readback, when the GPU has finished it. Step tells, which step it was.
+		bool getState(std::vector<float>& state, uint64_t* step = 0);
+
+	private:
+		friend class Window;
+		Feedback(const Feedback&) = delete;
+		Feedback& operator=(const Feedback&) = delete;
+
+		int                          m_width;
+		int                          m_height;
+		int                          m_channels;
+		bool                         m_wrap;
+		uint64_t                     m_steps;
+		std::vector<float>           m_pending;	// State set by setState, not uploaded yet.
+		bool                         m_dirty;
+
+		// GPU objects, created by Window.
+		std::shared_ptr<Texture>     m_textures[2];
+		std::unique_ptr<FrameBuffer> m_fbos[2];
+		int                          m_current;	// Index of the texture holding the current state.
+		unsigned int                 m_pbo;
+		void*                        m_fence;	// GLsync of the pending readback, or 0.
+		uint64_t                     m_readbackStep;
+	};
+
+}
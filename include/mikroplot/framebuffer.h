@@ -89,6 +89,7 @@ namespace mikroplot {
 		std::vector<GLenum>			m_drawBuffers;
 		GLuint						m_fboId;
 		unsigned int                m_rboId;
+		GLint                       m_previousFboId;	// Restored by unbind, so that framebuffers can be nested.
 
 		// Non-allowed methods (declared but not defined anywhere, result link error if used)
 		FrameBuffer( const FrameBuffer& );
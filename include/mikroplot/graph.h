@@ -0,0 +1,104 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/window.h>
+#include <vector>
+#include <utility>
+#include <stdint.h>
+
+namespace mikroplot {
+
+	struct LayoutOptions {
+		float repulsion = 1.0f;			// Strength of node repulsion.
+		float springLength = 1.0f;		// Rest length of edges.
+		float springStrength = 0.5f;	// Strength of edge attraction.
+		float gravity = 0.01f;			// Pull towards origin, keeps disconnected components together.
+		float theta = 0.8f;				// Barnes-Hut opening angle. 0 = exact O(n^2) repulsion.
+		float temperature = 0.0f;		// Initial maximum displacement per step. 0 = 0.1*springLength*sqrt(numNodes).
+		float cooling = 0.995f;			// Temperature multiplier per step.
+		float minTemperature = 0.01f;
+	};
+
+	///
+	/// \brief Force-directed graph layout with Barnes-Hut repulsion.
+	///
+	/// Each step builds a quadtree of nodes in Morton order and computes forces of all nodes in parallel:
+	/// repulsion from far away quadtree cells is approximated by their center of mass, so a step costs
+	/// O(n log n + edges). Layout runs incrementally: call step() once or few times per frame.
+	///
+	/// Window::drawGraph keeps node positions and edge indices in GPU buffers, uploads positions only when
+	/// they have changed, and draws all edges with one indexed draw call.
+	///
+	class GraphLayout {
+	public:
+		GraphLayout(std::size_t numNodes, const std::vector< std::pair<uint32_t,uint32_t> >& edges, const LayoutOptions& options = LayoutOptions());
+		~GraphLayout();
+
+		void step(std::size_t iterations = 1);
+
+		std::size_t getNumNodes() const { return m_positions.size(); }
+		const std::vector<vec2>& getPositions() const { return m_positions; }
+		const std::vector< std::pair<uint32_t,uint32_t> >& getEdges() const { return m_edges; }
+		void setPosition(std::size_t node, const vec2& position) { m_positions[node] = position; ++m_version; }
+		float getTemperature() const { return m_temperature; }
+
+	private:
+		friend class Window;
+		GraphLayout(const GraphLayout&) = delete;
+		GraphLayout& operator=(const GraphLayout&) = delete;
+
+		struct Cell {
+			vec2     center;		// Center of mass.
+			float    mass;
+			float    size;
+			uint32_t begin;			// Nodes m_order[begin ... end-1].
+			uint32_t end;
+			int32_t  children[4];	// -1, if leaf.
+		};
+		void buildTree();
+		int32_t buildCell(uint32_t begin, uint32_t end, float x0, float y0, float size, int depth);
+
+		LayoutOptions                             m_options;
+		std::vector<vec2>                         m_positions;
+		std::vector<vec2>                         m_next;
+		std::vector< std::pair<uint32_t,uint32_t> > m_edges;
+		std::vector<uint32_t>                     m_adjacencyStart;
+		std::vector<uint32_t>                     m_adjacency;
+		std::vector<uint32_t>                     m_order;	// Nodes sorted by Morton code.
+		std::vector<uint64_t>                     m_codes;
+		std::vector<Cell>                         m_cells;
+		float                                     m_temperature;
+		uint64_t                                  m_version;
+
+		// GPU buffers, created by Window on first draw.
+		uint32_t                                  m_vao;
+		uint32_t                                  m_positionBuffer;
+		uint32_t                                  m_indexBuffer;
+		uint64_t                                  m_uploadedVersion;
+	};
+
+}
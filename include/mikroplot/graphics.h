@@ -104,6 +104,40 @@ namespace mikroplot {
 				std::string("\n}\n"));
 		};
 
+		// Triangle covering the viewport, attributeless.
+		static std::string feedbackVSSource() {
+			return
+				std::string("#version 330 core\n") +
+				std::string("void main()\n") +
+				std::string("{\n") +
+				std::string("   vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n") +
+				std::string("   gl_Position = vec4(2.0*p - 1.0, 0.0, 1.0);\n") +
+				std::string("}");
+		}
+
+		// Next state of a Feedback cell. Main sets color, which is the state of the cell at start. state(dx, dy) is
+		// previous state of neighbor cell, cell and uv are coordinates of the cell and iteration is number of previous steps.
+		static std::string feedbackFSSource(const std::string& inputUniforms, const std::string& globals, const std::string& fragmentShaderMain) {
+			return
+				std::string("#version 330 core\n") +
+				std::string("out vec4 FragColor;\n") +
+				std::string("uniform sampler2D previous;\n") +
+				std::string("uniform vec2 cells;\n") +
+				std::string("uniform int iteration;\n") +
+				std::string("vec2 uv;\n") +
+				std::string("vec4 state(int dx, int dy) {\n") +
+				std::string("   return texture(previous, uv + vec2(dx, dy)/cells);\n") +
+				std::string("}\n") +
+				inputUniforms + "\n" +
+				globals + "\n" +
+				std::string("void main(){\n") +
+				std::string("uv = gl_FragCoord.xy/cells;\n") +
+				std::string("ivec2 cell = ivec2(gl_FragCoord.xy);\n") +
+				std::string("vec4 color = state(0, 0);\n") +
+				fragmentShaderMain + "\n" +
+				std::string("gl_FragData[0] = color;\n}\n");
+		}
+
 		static std::string textureFSSource(const std::string& inputUniforms, const std::string& globals, const std::string& shader){
 			return
 				std::string("#version 330 core\n") +
@@ -118,6 +152,162 @@ namespace mikroplot {
 				std::string("gl_FragData[0] = color;\n}\n");
 		}
 
+		static std::string functionVSSource(const std::string& inputUniforms, const std::string& globals, const std::string& expression) {
+			return
+				std::string("#version 330 core\n") +
+				std::string("uniform mat4 P;\n") +
+				std::string("uniform vec2 offset;\n") +
+				std::string("uniform float left;\n") +
+				std::string("uniform float right;\n") +
+				std::string("uniform float numSamples;\n") +
+				std::string("uniform float numInstances;\n") +
+				inputUniforms + "\n" +
+				std::string("float instance;\n") +
+				globals + "\n" +
+				std::string("void main()\n") +
+				std::string("{\n") +
+				std::string("   instance = float(gl_InstanceID);\n") +
+				std::string("   float x = mix(left, right, float(gl_VertexID) / max(numSamples-1.0, 1.0));\n") +
+				std::string("   float y = ") + expression + ";\n" +
+				std::string("   gl_Position = P*vec4(x+offset.x, y+offset.y, 0.0, 1.0);\n") +
+				std::string("}");
+		}
+
+		static std::string streamingVSSource() {
+			return
+				std::string("#version 330 core\n") +
+				std::string("uniform samplerBuffer samples;\n") +
+				std::string("uniform mat4 P;\n") +
+				std::string("uniform vec2 offset;\n") +
+				std::string("uniform int capacity;\n") +
+				std::string("uniform int numChannels;\n") +
+				std::string("uniform int channel;\n") +
+				std::string("uniform int first;\n") +
+				std::string("uniform float firstX;\n") +
+				std::string("uniform float dx;\n") +
+				std::string("void main()\n") +
+				std::string("{\n") +
+				std::string("   int ring = (first + gl_VertexID) % capacity;\n") +
+				std::string("   float y = texelFetch(samples, ring*numChannels + channel).r;\n") +
+				std::string("   float x = firstX + float(gl_VertexID)*dx;\n") +
+				std::string("   gl_Position = P*vec4(x+offset.x, y+offset.y, 0.0, 1.0);\n") +
+				std::string("}");
+		}
+
+		static std::string colorFSSource() {
+			return
+				std::string("#version 330 core\n") +
+				std::string("uniform vec4 color;\n") +
+				std::string("out vec4 FragColor;\n") +
+				std::string("void main(){\n") +
+				std::string("gl_FragData[0] = color;\n}\n");
+		}
+
+		// Splats each value as a point to its histogram slot (underflow, bins, overflow) of a width x height target.
+		static std::string histogramBinVSSource() {
+			return
+				std::string("#version 330 core\n") +
+				std::string("layout (location = 0) in float value;\n") +
+				std::string("uniform float minValue;\n") +
+				std::string("uniform float maxValue;\n") +
+				std::string("uniform int numBins;\n") +
+				std::string("uniform int width;\n") +
+				std::string("uniform int height;\n") +
+				std::string("void main()\n") +
+				std::string("{\n") +
+				// NaN is skipped, as in Histogram::add. Tested by bits, because value == value may be folded to true.
+				std::string("   if(isnan(value) || (floatBitsToUint(value) & 0x7fffffffu) > 0x7f800000u) { gl_Position = vec4(2.0, 2.0, 0.0, 1.0); return; }\n") +
+				std::string("   int slot = numBins + 1;\n") +
+				std::string("   if(value < minValue) slot = 0;\n") +
+				std::string("   else if(value <= maxValue) slot = 1 + min(int((value - minValue) / (maxValue - minValue) * float(numBins)), numBins - 1);\n") +
+				std::string("   vec2 pixel = vec2(float(slot % width), float(slot / width)) + 0.5;\n") +
+				std::string("   gl_Position = vec4(2.0*pixel.x/float(width) - 1.0, 2.0*pixel.y/float(height) - 1.0, 0.0, 1.0);\n") +
+				std::string("}");
+		}
+
+		// Positions from vertex buffer, for GPU resident point and line data.
+		static std::string positionVSSource() {
+			return
+				std::string("#version 330 core\n") +
+				std::string("layout (location = 0) in vec2 inPosition;\n") +
+				std::string("uniform mat4 P;\n") +
+				std::string("uniform vec2 offset;\n") +
+				std::string("void main()\n") +
+				std::string("{\n") +
+				std::string("   gl_Position = P*vec4(inPosition+offset, 0.0, 1.0);\n") +
+				std::string("}");
+		}
+
+		// Positions and texture coordinates from vertex buffer, for quads sampling a texture atlas.
+		static std::string atlasVSSource() {
+			return
+				std::string("#version 330 core\n") +
+				std::string("layout (location = 0) in vec2 inPosition;\n") +
+				std::string("layout (location = 1) in vec2 inTexCoord;\n") +
+				std::string("uniform mat4 P;\n") +
+				std::string("uniform vec2 offset;\n") +
+				std::string("out vec2 texCoord;\n") +
+				std::string("void main()\n") +
+				std::string("{\n") +
+				std::string("   texCoord = inTexCoord;\n") +
+				std::string("   gl_Position = P*vec4(inPosition+offset, 0.0, 1.0);\n") +
+				std::string("}");
+		}
+
+		// Bar of histogram per instance: heights from texture buffer, corners from gl_VertexID (triangle strip).
+		static std::string barsVSSource() {
+			return
+				std::string("#version 330 core\n") +
+				std::string("uniform samplerBuffer heights;\n") +
+				std::string("uniform mat4 P;\n") +
+				std::string("uniform vec2 offset;\n") +
+				std::string("uniform float x0;\n") +
+				std::string("uniform float binWidth;\n") +
+				std::string("uniform float barWidth;\n") +
+				std::string("void main()\n") +
+				std::string("{\n") +
+				std::string("   float h = texelFetch(heights, gl_InstanceID).r;\n") +
+				std::string("   float u = float(gl_VertexID & 1);\n") +
+				std::string("   float v = float(gl_VertexID >> 1);\n") +
+				std::string("   float x = x0 + (float(gl_InstanceID) + 0.5 + (u - 0.5)*barWidth)*binWidth;\n") +
+				std::string("   gl_Position = P*vec4(x+offset.x, v*h+offset.y, 0.0, 1.0);\n") +
+				std::string("}");
+		}
+
+		// Maps values of single channel float texture to heatToRGB colors, optionally through equalization lookup table.
+		static std::string heatMapFSSource() {
+			return
+				std::string("#version 330 core\n") +
+				std::string("in vec2 texCoord;\n") +
+				std::string("out vec4 FragColor;\n") +
+				std::string("uniform sampler2D texture0;\n") +
+				std::string("uniform sampler2D lut;\n") +
+				std::string("uniform float valueMin;\n") +
+				std::string("uniform float valueMax;\n") +
+				std::string("uniform int equalize;\n") +
+				std::string("uniform float lutSize;\n") +
+				std::string("uniform int logScale;\n") +
+				std::string("uniform int skipZero;\n") +
+				std::string("void main(){\n") +
+				std::string("   float v = texture(texture0, texCoord).r;\n") +
+				std::string("   if(isnan(v) || (skipZero != 0 && v == 0.0)) discard;\n") +
+				std::string("   if(logScale != 0) v = log(1.0 + max(v, 0.0));\n") +
+				std::string("   float t = clamp((v - valueMin) / max(valueMax - valueMin, 1e-30), 0.0, 1.0);\n") +
+				std::string("   if(equalize != 0) t = texture(lut, vec2((t*(lutSize-1.0) + 0.5) / lutSize, 0.5)).r;\n") +
+				std::string("   int h = int((1.0 - t) * 240.0);\n") +
+				std::string("   float up = floor(float(h % 40) / 40.0 * 255.0) / 255.0;\n") +
+				std::string("   float down = 1.0 - up;\n") +
+				std::string("   vec3 c = vec3(1.0);\n") +
+				std::string("   int segment = h / 40;\n") +
+				std::string("   if(segment == 0) c = vec3(1.0, down, down);\n") +
+				std::string("   else if(segment == 1) c = vec3(1.0, up, 0.0);\n") +
+				std::string("   else if(segment == 2) c = vec3(down, 1.0, 0.0);\n") +
+				std::string("   else if(segment == 3) c = vec3(0.0, 1.0, up);\n") +
+				std::string("   else if(segment == 4) c = vec3(0.0, down, 1.0);\n") +
+				std::string("   else if(segment == 5) c = vec3(0.0, 0.0, down);\n") +
+				std::string("   gl_FragData[0] = vec4(c, 1.0);\n}\n");
+		}
+
 		static std::string constants(const std::vector<Constant>& inputConstants) {
 			std::string res;
 			for(auto& c : inputConstants){
@@ -0,0 +1,74 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/column.h>
+#include <vector>
+#include <stdint.h>
+
+namespace mikroplot {
+
+	class Window;
+
+	///
+	/// \brief Histogram of float values with uniform bins over [min,max].
+	///
+	/// Values are binned in parallel to per-thread partial histograms, which are merged at the end of each add.
+	/// add can be called repeatedly, so arbitrary large data sets can be binned in chunks. Values equal to max
+	/// go to the last bin, values outside the range are counted as underflow and overflow and NaNs are ignored.
+	///
+	class Histogram {
+	public:
+		Histogram(float min, float max, std::size_t numBins);
+
+		void add(const float* values, std::size_t count);
+		void add(const std::vector<float>& values) { add(values.data(), values.size()); }
+		// Bins column view, for example a column of memory mapped ArrayFile.
+		void add(const ColumnView& values);
+		void clear();
+
+		float getMin() const { return m_min; }
+		float getMax() const { return m_max; }
+		float getBinWidth() const { return (m_max - m_min) / float(getNumBins()); }
+		std::size_t getNumBins() const { return m_counts.size() - 2; }
+		uint64_t getCount(std::size_t bin) const { return m_counts[bin+1]; }
+		uint64_t getUnderflow() const { return m_counts.front(); }
+		uint64_t getOverflow() const { return m_counts.back(); }
+		// Number of values added, including underflow and overflow.
+		uint64_t getTotal() const { return m_total; }
+
+	private:
+		friend class Window;	// Adds counts binned on the GPU.
+		template<typename View>
+		void addView(const View& values);
+
+		float                 m_min;
+		float                 m_max;
+		std::vector<uint64_t> m_counts;	// Underflow, bins and overflow.
+		uint64_t              m_total;
+	};
+
+}
@@ -0,0 +1,95 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/window.h>
+#include <cstdint>
+#include <vector>
+#include <map>
+
+namespace mikroplot {
+
+	///
+	/// \brief Compressed in-memory time series for long running live charts.
+	///
+	/// Samples are stored in blocks with Gorilla style encoding: timestamps as delta-of-deltas and
+	/// values as XOR against the previous value. Regularly sampled, slowly changing series take a few bits
+	/// per sample. Blocks are decoded lazily and in parallel, only for the visible range, and decoded
+	/// blocks are cached until they scroll out of view.
+	///
+	/// Timestamps are integers (for example milliseconds) and must be appended in non-decreasing order.
+	/// Sample is located at x = (timestamp - timeOrigin) * timeScale.
+	///
+	class SeriesHistory {
+	public:
+		SeriesHistory(double timeScale = 1.0, int64_t timeOrigin = 0, std::size_t blockSize = 1024);
+
+		void append(int64_t timestamp, float value);
+
+		///
+		/// \brief Returns decoded samples of range [left,right].
+		///
+		/// Samples closest to the range on both sides are included, so that lines continue to the edges.
+		/// Uses internal decode cache, so const instance must not be queried from multiple threads at once.
+		std::vector<vec2> query(double left, double right) const;
+
+		std::size_t getNumSamples() const { return m_numSamples; }
+		std::size_t getNumBlocks() const { return m_blocks.size(); }
+		// Memory used by compressed blocks in bytes (decode cache excluded).
+		std::size_t getCompressedSize() const;
+		double getBytesPerSample() const { return m_numSamples > 0 ? double(getCompressedSize()) / double(m_numSamples) : 0.0; }
+
+	private:
+		struct Block {
+			int64_t               firstTime;
+			int64_t               lastTime;
+			std::size_t           count = 0;
+			std::size_t           numBits = 0;
+			std::vector<uint64_t> bits;
+		};
+		// Encoder state of the last block.
+		struct Encoder {
+			int64_t  prevTime = 0;
+			int64_t  prevDelta = 0;
+			uint32_t prevValue = 0;
+			int      prevLeading = -1;
+			int      prevTrailing = 0;
+		};
+
+		void write(Block& block, uint64_t value, int numBits);
+		void decode(const Block& block, std::vector<vec2>& out) const;
+
+		double              m_timeScale;
+		int64_t             m_timeOrigin;
+		std::size_t         m_blockSize;
+		std::size_t         m_numSamples;
+		std::vector<Block>  m_blocks;
+		Encoder             m_encoder;
+		// Decoded blocks by block index. Last block is never cached, because it is still growing.
+		mutable std::map< std::size_t, std::vector<vec2> > m_cache;
+	};
+
+}
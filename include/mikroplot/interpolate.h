@@ -0,0 +1,90 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/window.h>
+#include <vector>
+#include <cstddef>
+#include <limits>
+
+namespace mikroplot {
+
+	struct InterpolationOptions {
+		std::size_t neighbors = 8;		// Nearest sensors used for each cell.
+		float       power = 2.0f;		// Sensors are weighted by 1/distance^power.
+		float       maxDistance = std::numeric_limits<float>::infinity();	// Cells without sensors within maxDistance are NaN.
+		std::size_t tileSize = 32;
+	};
+
+	///
+	/// \brief Inverse distance weighted interpolation of scattered sensors to a heat map grid.
+	///
+	/// Nearest sensors are found with a k-d tree, which is built in parallel. Tiles of the grid are
+	/// interpolated in parallel and each tile remembers the distance of the farthest sensor it used.
+	/// When a sensor changes, only tiles within that distance from its old or new position are recomputed.
+	///
+	class Interpolator {
+	public:
+		// Grid of width x height cells over view. Row 0 is the top of the view, as in drawHeatMap.
+		Interpolator(std::size_t width, std::size_t height, float left, float right, float bottom, float top, const InterpolationOptions& options = InterpolationOptions());
+
+		void setSensors(const std::vector<vec2>& positions, const std::vector<float>& values);
+		void setValue(std::size_t sensor, float value);
+		void setPosition(std::size_t sensor, const vec2& position);
+
+		// Recomputes tiles affected by the changes. Returns number of recomputed tiles.
+		std::size_t update();
+
+		const HeatMap& getHeatMap() const { return m_grid; }
+		std::size_t getNumSensors() const { return m_positions.size(); }
+
+	private:
+		struct Tile {
+			std::size_t x0, y0, x1, y1;
+			float       radius2;	// Squared distance of the farthest sensor used.
+			bool        dirty;
+		};
+		typedef std::vector< std::pair<float, uint32_t> > Neighbors;
+
+		void build(std::size_t begin, std::size_t end);
+		void search(std::size_t begin, std::size_t end, const vec2& position, float maxDistance2, Neighbors& heap) const;
+		void markDirty(const vec2& position);
+		void computeTile(Tile& tile);
+
+		InterpolationOptions  m_options;
+		float                 m_left, m_top;
+		float                 m_cellWidth, m_cellHeight;
+		HeatMap               m_grid;
+		std::vector<Tile>     m_tiles;
+		std::vector<vec2>     m_positions;
+		std::vector<float>    m_values;
+		std::vector<uint32_t> m_tree;		// Implicit k-d tree: median of each range splits it along m_splitAxis.
+		std::vector<uint8_t>  m_splitAxis;
+		std::vector<vec2>     m_treePositions;	// Positions in tree order, for cache friendly search.
+		bool                  m_treeDirty;
+	};
+
+}
@@ -0,0 +1,121 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <functional>
+#include <string>
+#include <memory>
+#include <map>
+#include <algorithm>
+#include <stdint.h>
+
+namespace mikroplot {
+
+	struct JobConfig {
+		std::size_t numThreads = 0;		// Total number of threads, including calling thread. 0 = hardware concurrency.
+		bool        pinThreads = false;	// Pin worker threads to cores.
+		std::size_t firstCore  = 0;		// First core, where worker threads are pinned.
+	};
+
+	struct JobTiming {
+		std::size_t calls = 0;
+		std::size_t tasks = 0;
+		double      totalSeconds = 0.0;
+		double      lastSeconds = 0.0;
+	};
+
+	///
+	/// \brief Work-stealing job system used for CPU side data preparation.
+	///
+	/// Each worker thread has its own task queue. Idle workers steal tasks from the other queues and
+	/// the thread calling parallelFor executes tasks too, until the whole job is done. Nested calls
+	/// of parallelFor are allowed.
+	///
+	class JobSystem {
+	public:
+		explicit JobSystem(const JobConfig& config = JobConfig());
+		~JobSystem();
+
+		// Returns library wide job system.
+		static JobSystem& get();
+		// Recreates library wide job system. Must not be called while jobs are running.
+		static void configure(const JobConfig& config);
+
+		std::size_t getNumThreads() const;
+
+		///
+		/// \brief Calls f(rangeBegin, rangeEnd) for subranges of [begin, end) in parallel.
+		///
+		/// Each subrange has at least grain items, so small ranges are executed on the calling thread.
+		template<typename F>
+		void parallelFor(const char* name, std::size_t begin, std::size_t end, std::size_t grain, F f) {
+			if(end <= begin) {
+				return;
+			}
+			grain = std::max<std::size_t>(grain, 1);
+			std::size_t count = end - begin;
+			// Rounded up without overflow, even for grain near the maximum of size_t.
+			std::size_t numChunks = std::max<std::size_t>(1, std::min(count/grain + (count%grain != 0), 4*getNumThreads()));
+			std::size_t chunkSize = (count + numChunks - 1) / numChunks;
+			run(name, numChunks, [&](std::size_t chunk) {
+				std::size_t b = begin + chunk*chunkSize;
+				std::size_t e = std::min(end, b + chunkSize);
+				if(b < e) {
+					f(b, e);
+				}
+			});
+		}
+
+		///
+		/// \brief Calls f(x0, y0, x1, y1) for each tile of width x height area in parallel.
+		template<typename F>
+		void parallelForTiles(const char* name, std::size_t width, std::size_t height, std::size_t tileSize, F f) {
+			tileSize = std::max<std::size_t>(tileSize, 1);
+			std::size_t tilesX = (width + tileSize - 1) / tileSize;
+			std::size_t tilesY = (height + tileSize - 1) / tileSize;
+			run(name, tilesX*tilesY, [&](std::size_t tile) {
+				std::size_t x0 = (tile % tilesX) * tileSize;
+				std::size_t y0 = (tile / tilesX) * tileSize;
+				f(x0, y0, std::min(width, x0 + tileSize), std::min(height, y0 + tileSize));
+			});
+		}
+
+		// Executes task(index) for index = 0 ... numTasks-1 and waits for completion.
+		void run(const char* name, std::size_t numTasks, const std::function<void(std::size_t)>& task);
+
+		// Accumulated timings by job name.
+		std::map<std::string, JobTiming> getTimings() const;
+		void resetTimings();
+
+	private:
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		struct Impl;
+		std::unique_ptr<Impl> m_impl;
+	};
+
+}
@@ -0,0 +1,106 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/column.h>
+#include <string>
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+namespace mikroplot {
+
+	///
+	/// \brief Access pattern hint for memory mapped files (madvise).
+	enum class AccessPattern {
+		NORMAL,
+		SEQUENTIAL,	// Read ahead aggressively, for example when building an index.
+		RANDOM		// No read ahead, for example when zooming into an index.
+	};
+
+	///
+	/// \brief Read only memory mapped file. Throws std::runtime_error, if the file can not be mapped.
+	class MappedFile {
+	public:
+		explicit MappedFile(const std::string& fileName);
+		~MappedFile();
+
+		const uint8_t* getData() const { return m_data; }
+		std::size_t getSize() const { return m_size; }
+		// Last modification time of the file when it was opened, in platform specific units. For comparison only.
+		int64_t getModificationTime() const { return m_modificationTime; }
+
+		// Gives access pattern hint for the whole file.
+		void advise(AccessPattern pattern) const;
+
+	private:
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const uint8_t* m_data;
+		std::size_t    m_size;
+		int64_t        m_modificationTime;
+#if defined(_WIN32)
+		void*          m_file;
+		void*          m_mapping;
+#endif
+	};
+
+	///
+	/// \brief Memory mapped 1D or 2D array of float32 or float64 values.
+	///
+	/// Arrays are stored row by row (C order) or column by column (Fortran order). Columns are exposed as
+	/// zero-copy strided views, which can be passed straight to draw, decimation and index functions.
+	///
+	class ArrayFile {
+	public:
+		// Opens raw binary file: optional header of headerBytes, followed by rows of numColumns values.
+		static std::shared_ptr<ArrayFile> openRaw(const std::string& fileName, DataType type, std::size_t numColumns = 1, std::size_t headerBytes = 0);
+		// Opens NumPy .npy file (format versions 1-3, little endian '<f4' or '<f8', 1D or 2D).
+		static std::shared_ptr<ArrayFile> openNpy(const std::string& fileName);
+
+		std::size_t getNumRows() const { return m_numRows; }
+		std::size_t getNumColumns() const { return m_numColumns; }
+		DataType getType() const { return m_type; }
+		// Zero-copy view to column. View is valid as long as this ArrayFile exists.
+		ColumnView column(std::size_t index) const;
+		void advise(AccessPattern pattern) const { m_file->advise(pattern); }
+		// Size and modification time of the file, for example to detect that cached data derived from it is stale.
+		std::size_t getFileSize() const { return m_file->getSize(); }
+		int64_t getModificationTime() const { return m_file->getModificationTime(); }
+
+		ArrayFile(std::unique_ptr<MappedFile> file, std::size_t offset, DataType type, std::size_t numRows, std::size_t numColumns, bool columnMajor);
+
+	private:
+		std::unique_ptr<MappedFile> m_file;
+		std::size_t                 m_offset;
+		DataType                    m_type;
+		std::size_t                 m_numRows;
+		std::size_t                 m_numColumns;
+		bool                        m_columnMajor;
+	};
+
+}
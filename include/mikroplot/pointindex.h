@@ -0,0 +1,83 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/window.h>
+#include <mikroplot/column.h>
+#include <vector>
+#include <cstddef>
+#include <limits>
+
+namespace mikroplot {
+
+	///
+	/// \brief Uniform grid index over points, for hover, picking and rectangle selection.
+	///
+	/// Grid is built with parallel counting sort, so that each cell holds about 16 points. Appended
+	/// points are linked to pending lists of their cells in constant time, until they grow over 1/8 of the
+	/// indexed points and the grid is rebuilt. Points with NaN coordinates are never returned.
+	///
+	/// query() returns indices of points in the order they were added.
+	///
+	class PointIndex {
+	public:
+		explicit PointIndex(const std::vector<vec2>& points = std::vector<vec2>());
+		PointIndex(const ColumnView& x, const ColumnView& y);
+
+		void append(const vec2& point);
+		void append(const std::vector<vec2>& points);
+
+		///
+		/// \brief Returns index of the point nearest to position, or -1 if there is no point within maxDistance.
+		///
+		/// Distance is measured after multiplying coordinate differences by scale, for example by pixels per unit,
+		/// when x and y axis have different units.
+		std::ptrdiff_t nearest(const vec2& position, float maxDistance = std::numeric_limits<float>::infinity(), const vec2& scale = vec2(1.0f, 1.0f)) const;
+		// Appends indices of points inside rectangle to result.
+		void query(float left, float right, float bottom, float top, std::vector<std::size_t>& result) const;
+
+		const std::vector<vec2>& getPoints() const { return m_points; }
+		std::size_t size() const { return m_points.size(); }
+
+	private:
+		void build();
+		// Links point i to pending list of its cell.
+		void insertPending(std::size_t i);
+		int cellX(float x) const;
+		int cellY(float y) const;
+
+		std::vector<vec2>        m_points;
+		std::size_t              m_numIndexed;	// Points [0,m_numIndexed) are in the grid, others are pending.
+		float                    m_minX, m_minY;
+		float                    m_cellsPerUnitX, m_cellsPerUnitY;
+		int                      m_numCellsX, m_numCellsY;
+		std::vector<uint32_t>    m_cellStart;	// Points of cell c are m_indices[m_cellStart[c] ... m_cellStart[c+1]-1].
+		std::vector<uint32_t>    m_indices;
+		std::vector<uint32_t>    m_pendingHead;	// Last pending point of each cell.
+		std::vector<uint32_t>    m_pendingNext;	// Previous pending point of the same cell, for points [m_numIndexed, size()).
+	};
+
+}
@@ -0,0 +1,79 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <memory>
+#include <stdint.h>
+
+namespace mikroplot {
+
+	struct PosterOptions {
+		int tileSize = 1024;		// Output pixels per tile side. Memory use is about width*tileSize*3 bytes.
+		int supersampling = 1;		// Each output pixel is the average of supersampling x supersampling samples.
+		int compression = 6;		// zlib compression level 0-9.
+	};
+
+	///
+	/// \brief Streaming PNG encoder: rows are filtered, compressed and written as they arrive.
+	///
+	/// Compresses with zlib, when built with MIKROPLOT_USE_ZLIB. Otherwise writes uncompressed deflate blocks,
+	/// which gives valid, but large files.
+	///
+	class PngWriter {
+	public:
+		PngWriter();
+		~PngWriter();
+
+		// Writes signature and header. Channels is 3 (RGB) or 4 (RGBA). Returns false, if the file can not be written.
+		bool open(const std::string& fileName, int width, int height, int channels, int compression = 6);
+		// Appends tightly packed rows, top row first.
+		bool writeRows(const uint8_t* rows, int numRows);
+		// Writes the rest of the image. Returns false, if any write failed or rows are missing.
+		bool finish();
+
+	private:
+		PngWriter(const PngWriter&) = delete;
+		PngWriter& operator=(const PngWriter&) = delete;
+
+		struct Deflate;
+		bool compress(const uint8_t* data, std::size_t size, bool last);
+		bool writeChunk(const char type[4], const uint8_t* data, std::size_t size);
+
+		FILE*                    m_file;
+		int                      m_width;
+		int                      m_height;
+		int                      m_channels;
+		int                      m_rowsWritten;
+		bool                     m_ok;
+		std::vector<uint8_t>     m_filtered;
+		std::vector<uint8_t>     m_output;	// Compressed data, written as IDAT chunks.
+		std::unique_ptr<Deflate> m_deflate;
+	};
+
+}
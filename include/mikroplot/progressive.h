@@ -0,0 +1,85 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <array>
+#include <cstddef>
+#include <stdint.h>
+
+namespace mikroplot {
+
+	class FrameBuffer;
+	class Window;
+
+	struct ProgressiveOptions {
+		int    tileSize = 128;				// Tile side in pixels.
+		double budgetMilliseconds = 8.0;	// GPU time for tiles per frame. At least one tile is rendered each frame.
+	};
+
+	///
+	/// \brief Accumulated result of Window::shade with a time budget.
+	///
+	/// Tiles of the screen are rendered center first, as many per frame as fit the budget according to GPU timer
+	/// queries of the previous frames. Rendered tiles are kept while the shader, constants, view and screen size
+	/// stay the same, so the image is completed over several frames.
+	///
+	class ProgressiveShade {
+	public:
+		ProgressiveShade();
+		~ProgressiveShade();
+
+		// Starts again from the first tile on the next frame.
+		void invalidate() { m_key.clear(); }
+		// Returns true, if every tile has been rendered.
+		bool isComplete() const { return !m_order.empty() && m_nextTile >= m_order.size(); }
+		// Returns fraction of tiles rendered.
+		float getProgress() const { return m_order.empty() ? 0.0f : float(m_nextTile) / float(m_order.size()); }
+		// Returns estimated GPU time per tile in milliseconds, or 0 before the first measurement.
+		double getTileMilliseconds() const { return m_tileMilliseconds; }
+
+	private:
+		friend class Window;
+		ProgressiveShade(const ProgressiveShade&) = delete;
+		ProgressiveShade& operator=(const ProgressiveShade&) = delete;
+
+		// Updates tile time from finished timer queries, without waiting for the GPU.
+		void collectQueries();
+
+		static const int NUM_QUERIES = 4;
+
+		std::unique_ptr<FrameBuffer>  m_fbo;	// Accumulated tiles, created by Window.
+		std::string                   m_key;	// Shader, constants, view and size of the accumulated tiles.
+		std::vector<std::array<int,4> > m_order;	// Tiles as x, y, width, height in rendering order.
+		std::size_t                   m_nextTile;
+		double                        m_tileMilliseconds;
+		unsigned int                  m_queries[NUM_QUERIES];
+		int                           m_queryTiles[NUM_QUERIES];	// Tiles measured by a pending query, 0 if free.
+	};
+
+}
@@ -0,0 +1,93 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/window.h>
+#include <mikroplot/column.h>
+#include <vector>
+#include <string>
+
+namespace mikroplot {
+
+	///
+	/// \brief Multi-resolution min/max index of a uniformly sampled series.
+	///
+	/// Level 0 stores min and max of each leafSize samples, and every next level combines branching
+	/// buckets of the previous level. Any view is answered by reading at most O(columns * branching)
+	/// summary entries, or O(columns * leafSize) raw samples, when the view is zoomed in near sample level.
+	/// Index takes 2/leafSize * branching/(branching-1) floats per sample.
+	///
+	/// Sample i is located at x = x0 + i*dx. Samples are not copied: they must stay valid as long as the
+	/// pyramid is used.
+	///
+	class SeriesPyramid {
+	public:
+		SeriesPyramid(const float* values, std::size_t count, double x0 = 0.0, double dx = 1.0, std::size_t leafSize = 64, std::size_t branching = 8);
+		// Pyramid for a column view, for example a column of memory mapped ArrayFile.
+		SeriesPyramid(const ColumnView& values, double x0 = 0.0, double dx = 1.0, std::size_t leafSize = 64, std::size_t branching = 8);
+
+		// Builds index in parallel.
+		void build();
+		// Saves index to file. Returns false on failure.
+		bool save(const std::string& fileName) const;
+		///
+		/// \brief Loads index saved by save(). Returns false, if file does not exist or does not match the series.
+		///
+		/// Index stores a hash of evenly spaced samples, which is checked in constant time, so an index of
+		/// regenerated data of the same length is not used. A change of a few samples between them is detected
+		/// only with verifyAll, which checks a checksum of all samples and costs about as much as build().
+		bool load(const std::string& fileName, bool verifyAll = false);
+		// Loads index from file, or builds and saves it if loading fails.
+		void loadOrBuild(const std::string& fileName, bool verifyAll = false);
+
+		///
+		/// \brief Returns min/max polyline of range [left,right] with two points per column.
+		///
+		/// Points closest to the range on both sides are included, so that lines continue to the edges.
+		std::vector<vec2> query(double left, double right, std::size_t columns) const;
+
+		std::size_t getCount() const { return m_count; }
+		std::size_t getNumLevels() const { return m_levels.size(); }
+		// Memory used by the index in bytes.
+		std::size_t getIndexSize() const;
+
+	private:
+		struct Level {
+			std::size_t        bucketSize;	// Number of samples per bucket.
+			std::vector<float> mins;
+			std::vector<float> maxs;
+		};
+
+		ColumnView         m_values;
+		std::size_t        m_count;
+		double             m_x0;
+		double             m_dx;
+		std::size_t        m_leafSize;
+		std::size_t        m_branching;
+		std::vector<Level> m_levels;
+	};
+
+}
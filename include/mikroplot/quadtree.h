@@ -0,0 +1,73 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/window.h>
+#include <vector>
+#include <array>
+#include <stdint.h>
+
+namespace mikroplot {
+
+	///
+	/// \brief Quadtree over scatter points for view culling and level of detail.
+	///
+	/// Points are reordered, so that every node covers a contiguous range of them. Each node also keeps
+	/// a representative sample (every k-th point of its range). Query returns full leaves for sparse
+	/// regions and node samples for regions, where there are more points than pixels, so the number of
+	/// submitted points follows the visible pixel area instead of the data size.
+	///
+	class PointQuadtree {
+	public:
+		explicit PointQuadtree(const std::vector<vec2>& points, std::size_t leafSize = 4096, std::size_t sampleSize = 256);
+
+		///
+		/// \brief Returns points to draw for view [left,right]x[bottom,top] of size widthPx x heightPx pixels.
+		///
+		/// Nodes outside the view are culled. Node sample is used instead of its children, when the node
+		/// covers less than sampleSize/pointsPerPixel pixels.
+		std::vector<vec2> query(float left, float right, float bottom, float top, int widthPx, int heightPx, float pointsPerPixel = 1.0f) const;
+
+		// Points in tree order.
+		const std::vector<vec2>& getPoints() const { return m_points; }
+		std::size_t getNumNodes() const { return m_nodes.size(); }
+
+	private:
+		struct Node {
+			std::array<float,4>   bounds;		// left, right, bottom, top
+			uint32_t              begin;
+			uint32_t              end;
+			std::array<int32_t,4> children;		// -1, if leaf.
+			std::vector<vec2>     sample;
+		};
+
+		std::vector<vec2> m_points;
+		std::vector<Node> m_nodes;
+		std::size_t       m_leafSize;
+		std::size_t       m_sampleSize;
+	};
+
+}
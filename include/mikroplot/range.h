@@ -0,0 +1,72 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+namespace mikroplot {
+
+	/// \brief Auto-range mode for value to color mapping.
+	enum class AutoRange {
+		MIN_MAX,		// Linear mapping from data min to data max.
+		PERCENTILE,		// Linear mapping between low and high percentiles, outliers are clamped.
+		EQUALIZE		// Histogram equalization between low and high percentiles.
+	};
+
+	struct RangeOptions {
+		AutoRange   mode = AutoRange::MIN_MAX;
+		float       lowPercentile = 1.0f;
+		float       highPercentile = 99.0f;
+		std::size_t lutSize = 256;	// Size of equalization lookup table.
+
+		bool operator==(const RangeOptions& other) const = default;
+	};
+
+	struct ValueRange {
+		float              min = 0.0f;
+		float              max = 1.0f;
+		// Equalization: maps normalized value (value-min)/(max-min) sampled at lutSize points to [0,1]. Empty for linear mapping.
+		std::vector<float> lut;
+	};
+
+	namespace range {
+		///
+		/// \brief Computes range of values in one parallel pass.
+		///
+		/// Min and max are reduced with SIMD. Percentiles and equalization use a histogram of the 16 high bits
+		/// of order preserving float keys, which needs no range up front and has about 1% relative resolution.
+		/// NaN values are ignored.
+		ValueRange compute(const float* values, std::size_t count, const RangeOptions& options = RangeOptions());
+		// Same for values of several arrays (pointer and count), without copying them together.
+		ValueRange compute(const std::vector< std::pair<const float*, std::size_t> >& arrays, const RangeOptions& options = RangeOptions());
+
+		// Copies rows to dst as tightly packed rows and computes range of the values in the same pass.
+		ValueRange flatten(const std::vector< std::vector<float> >& rows, float* dst, const RangeOptions& options = RangeOptions());
+	}
+
+}
@@ -0,0 +1,147 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/range.h>
+#include <mikroplot/column.h>
+#include <vector>
+#include <string>
+#include <memory>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+
+namespace mikroplot {
+
+	class ArrayFile;
+	class MappedFile;
+	class Texture;
+	class Window;
+
+	struct RasterOptions {
+		std::size_t tileSize = 256;
+		std::size_t maxGpuTiles = 512;		// Tiles kept in GPU memory, least recently used are dropped.
+		std::size_t maxLoadedTiles = 64;	// Tiles loaded, but not yet uploaded.
+		std::size_t maxUploadsPerFrame = 16;
+	};
+
+	///
+	/// \brief Out-of-core tiled image pyramid of a large 2D raster, drawn with Window::drawRaster.
+	///
+	/// Level 0 is read from the memory mapped raster. Coarser levels, each halving the resolution by averaging,
+	/// are built once in parallel to a memory mapped cache file. Rows of all levels are produced in a single
+	/// streaming pass, so building needs memory only for a band of rows.
+	///
+	/// Tiles visible at the current zoom level are read by a loader thread and uploaded by Window to a least
+	/// recently used cache of tile textures. Until a tile is resident, its nearest resident coarser tile is drawn.
+	/// Memory use is bounded by the options, not by the size of the raster.
+	///
+	class RasterPyramid {
+	public:
+		// Raster has numRows rows of numColumns values, row 0 drawn at the top.
+		RasterPyramid(std::shared_ptr<ArrayFile> raster, const std::string& cacheFileName, const RasterOptions& options = RasterOptions());
+		~RasterPyramid();
+
+		// Builds coarser levels in parallel to the cache file.
+		void build();
+		// Maps levels built earlier. Returns false, if the cache file does not exist or does not match the raster.
+		// The cache records size and modification time of the raster file, so a regenerated raster is rebuilt.
+		bool load();
+		// Loads levels from the cache file, or builds them if loading fails.
+		void loadOrBuild();
+
+		// Area covered by the raster in view coordinates. Default is one unit per value of level 0.
+		void setBounds(float left, float right, float bottom, float top);
+
+		std::size_t getWidth() const { return m_levels.empty() ? 0 : m_levels[0].width; }
+		std::size_t getHeight() const { return m_levels.empty() ? 0 : m_levels[0].height; }
+		std::size_t getNumLevels() const { return m_levels.size(); }
+		std::size_t getNumResidentTiles() const { return m_resident.size(); }
+
+	private:
+		friend class Window;
+		RasterPyramid(const RasterPyramid&) = delete;
+		RasterPyramid& operator=(const RasterPyramid&) = delete;
+
+		struct Level {
+			std::size_t  width;
+			std::size_t  height;
+			std::size_t  offset;	// Byte offset in the cache file, levels > 0.
+			const float* values;	// Mapped values, levels > 0.
+		};
+		struct LoadedTile {
+			uint64_t           key;
+			std::vector<float> values;
+		};
+		struct ResidentTile {
+			std::shared_ptr<Texture> texture;
+			uint64_t                 lastUsed;	// Frame number.
+		};
+
+		static uint64_t tileKey(std::size_t level, std::size_t x, std::size_t y);
+		static std::size_t tileLevel(uint64_t key) { return std::size_t(key >> 56); }
+		static std::size_t tileX(uint64_t key) { return std::size_t(key & 0xFFFFFFF); }
+		static std::size_t tileY(uint64_t key) { return std::size_t((key >> 28) & 0xFFFFFFF); }
+		void tileSize(uint64_t key, std::size_t& width, std::size_t& height) const;
+		void readTile(uint64_t key, std::vector<float>& values) const;
+		// Replaces queued requests.
+		void request(const std::vector<uint64_t>& keys);
+		// Moves at most maxTiles loaded tiles to result.
+		void collect(std::size_t maxTiles, std::vector<LoadedTile>& result);
+		void loaderThread();
+		void stopLoader();
+
+		RasterOptions                  m_options;
+		std::shared_ptr<ArrayFile>     m_raster;
+		std::vector<ColumnView>        m_columns;
+		std::string                    m_cacheFileName;
+		std::unique_ptr<MappedFile>    m_cache;
+		std::vector<Level>             m_levels;
+		float                          m_left, m_right, m_bottom, m_top;
+
+		// Loader thread state, guarded by m_mutex.
+		std::thread                    m_loader;
+		std::mutex                     m_mutex;
+		std::condition_variable        m_condition;
+		std::deque<uint64_t>           m_requests;
+		std::vector<LoadedTile>        m_loaded;
+		uint64_t                       m_loading;
+		bool                           m_quit;
+
+		// GPU state, managed by Window.
+		std::unordered_map<uint64_t, ResidentTile> m_resident;
+		uint64_t                       m_frame;
+		RangeOptions                   m_rangeOptions;
+		ValueRange                     m_range;
+		bool                           m_rangeValid;
+		uint32_t                       m_vao;
+		uint32_t                       m_vertexBuffer;
+	};
+
+}
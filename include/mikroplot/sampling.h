@@ -0,0 +1,157 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/jobs.h>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace mikroplot {
+
+	///
+	/// \brief Options for adaptive function sampling.
+	struct SamplingOptions {
+		int         initialStep = 4;		// Distance of initial samples in pixels.
+		float       maxPixelError = 0.5f;	// Maximum distance of linear interpolation from the function in pixels.
+		float       minPixelStep = 0.125f;	// Intervals are not refined below this width in pixels.
+		int         maxDepth = 8;			// Maximum number of refinement passes.
+		std::size_t batchSize = 16;			// Number of samples evaluated by a single job.
+		bool        parallel = false;		// Evaluate function in parallel. Opt-in, because function must be thread safe.
+	};
+
+	namespace sampling {
+		///
+		/// \brief Samples y=f(x) on the x-range [left,right] adaptively.
+		///
+		/// Function is first evaluated every options.initialStep pixels. Then intervals, where the curve bends
+		/// more than options.maxPixelError pixels, are split by evaluating their midpoints. All midpoints of a
+		/// refinement pass are evaluated as a single parallel batch. Non-finite values are dropped.
+		///
+		/// \param out Sampled points. Point type must be constructible from (float x, float y).
+		template<typename Point, typename F>
+		void adaptive(std::vector<Point>& out, const F& f, float left, float right, float bottom, float top,
+					  int widthPixels, int heightPixels, const SamplingOptions& options = SamplingOptions()) {
+			out.clear();
+			if(widthPixels <= 0 || heightPixels <= 0 || left == right) {
+				return;
+			}
+			const float pixelsPerX = float(widthPixels) / std::abs(right-left);
+			const float pixelsPerY = top != bottom ? float(heightPixels) / std::abs(top-bottom) : 0.0f;
+			const float maxError = std::max(options.maxPixelError, 1e-3f);
+
+			auto evaluate = [&](const std::vector<float>& xs, std::vector<float>& ys) {
+				ys.resize(xs.size());
+				if(!options.parallel) {
+					for(std::size_t i=0; i<xs.size(); ++i) {
+						ys[i] = float(f(xs[i]));
+					}
+					return;
+				}
+				const std::size_t grain = std::max<std::size_t>(1, options.batchSize);
+				JobSystem::get().parallelFor("drawFunction", 0, xs.size(), grain, [&](std::size_t begin, std::size_t end) {
+					for(std::size_t i=begin; i<end; ++i) {
+						ys[i] = float(f(xs[i]));
+					}
+				});
+			};
+
+			// Initial uniform samples
+			std::size_t step = std::size_t(std::max(1, options.initialStep));
+			std::size_t n = std::size_t(widthPixels) / step + 2;
+			std::vector<float> xs(n);
+			std::vector<float> ys;
+			for(std::size_t i=0; i<n; ++i) {
+				xs[i] = left + (right-left) * float(i) / float(n-1);
+			}
+			evaluate(xs, ys);
+
+			// Interval i = [i, i+1] is refined, if neighbouring samples deviate from straight line too much.
+			auto deviation = [&](std::size_t a, std::size_t b, std::size_t c) {
+				float t = (xs[b]-xs[a]) / (xs[c]-xs[a]);
+				float lin = ys[a] + t*(ys[c]-ys[a]);
+				return std::abs(ys[b]-lin) * pixelsPerY;
+			};
+			std::vector<char> refine(n-1, 0);
+			for(std::size_t i=1; i+1<n; ++i) {
+				if(!std::isfinite(ys[i-1]) || !std::isfinite(ys[i]) || !std::isfinite(ys[i+1]) || deviation(i-1, i, i+1) > maxError) {
+					refine[i-1] = refine[i] = 1;
+				}
+			}
+
+			std::vector<float> midXs;
+			std::vector<float> midYs;
+			std::vector<float> newXs;
+			std::vector<float> newYs;
+			std::vector<char> newRefine;
+			for(int depth=0; depth<options.maxDepth; ++depth) {
+				midXs.clear();
+				for(std::size_t i=0; i+1<xs.size(); ++i) {
+					if(refine[i] && std::abs(xs[i+1]-xs[i]) * pixelsPerX > options.minPixelStep) {
+						midXs.push_back(0.5f*(xs[i]+xs[i+1]));
+					}
+				}
+				if(midXs.empty()) {
+					break;
+				}
+				evaluate(midXs, midYs);
+				// Merge midpoints and decide, which of the new intervals need further refinement.
+				newXs.clear();
+				newYs.clear();
+				newRefine.clear();
+				std::size_t m = 0;
+				for(std::size_t i=0; i+1<xs.size(); ++i) {
+					newXs.push_back(xs[i]);
+					newYs.push_back(ys[i]);
+					if(m < midXs.size() && refine[i] && midXs[m] == 0.5f*(xs[i]+xs[i+1])) {
+						float lin = 0.5f*(ys[i]+ys[i+1]);
+						bool bad = !std::isfinite(midYs[m]) || std::abs(midYs[m]-lin) * pixelsPerY > maxError;
+						newXs.push_back(midXs[m]);
+						newYs.push_back(midYs[m]);
+						newRefine.push_back(bad);
+						newRefine.push_back(bad);
+						++m;
+					} else {
+						newRefine.push_back(0);
+					}
+				}
+				newXs.push_back(xs.back());
+				newYs.push_back(ys.back());
+				std::swap(xs, newXs);
+				std::swap(ys, newYs);
+				std::swap(refine, newRefine);
+			}
+
+			out.reserve(xs.size());
+			for(std::size_t i=0; i<xs.size(); ++i) {
+				if(std::isfinite(ys[i])) {
+					out.emplace_back(xs[i], ys[i]);
+				}
+			}
+		}
+	}
+
+}
@@ -0,0 +1,125 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <vector>
+#include <memory>
+#include <array>
+#include <stdint.h>
+
+namespace mikroplot {
+
+	class Texture;
+	class Window;
+
+	/// \brief Aggregation of nonzeros falling into the same screen pixel.
+	enum class Aggregate {
+		COUNT,
+		SUM,
+		MAX
+	};
+
+	///
+	/// \brief Pixel lattice of a zoom level. Pixel (i,j), j down from the top of the screen, covers columns
+	/// [(x+i)*colsPerPixel, (x+i+1)*colsPerPixel) and rows [(y+j)*rowsPerPixel, (y+j+1)*rowsPerPixel).
+	struct PixelGrid {
+		int64_t x = 0;
+		int64_t y = 0;
+		double  colsPerPixel = 1;
+		double  rowsPerPixel = 1;
+		int     width = 0;
+		int     height = 0;
+	};
+
+	///
+	/// \brief Sparse matrix in CSR format with sorted column indices.
+	///
+	/// Entry (row, col) is drawn at x in [col, col+1] and y in [-row-1, -row], so row 0 is at the top:
+	/// setScreen(0, numCols, -numRows, 0) shows the whole matrix.
+	///
+	class SparseMatrix {
+	public:
+		// CSR arrays: rowStart has numRows+1 offsets to columns and values. Empty values means all ones.
+		SparseMatrix(std::size_t numRows, std::size_t numCols, const std::vector<uint64_t>& rowStart, const std::vector<uint32_t>& columns, const std::vector<float>& values = {});
+		// Converts COO triplets to CSR.
+		static SparseMatrix fromCOO(std::size_t numRows, std::size_t numCols, const std::vector<uint32_t>& rows, const std::vector<uint32_t>& columns, const std::vector<float>& values = {});
+
+		std::size_t getNumRows() const { return m_numRows; }
+		std::size_t getNumCols() const { return m_numCols; }
+		std::size_t getNumNonZeros() const { return m_columns.size(); }
+
+		///
+		/// \brief Aggregates entries to pixels [x0,x1) x [y0,y1) of grid in parallel.
+		///
+		/// out has grid.width*grid.height values. Only visible entries are visited: rows by range and columns by
+		/// binary search. Pixels without entries are NaN.
+		void aggregate(const PixelGrid& grid, int x0, int y0, int x1, int y1, Aggregate mode, float* out) const;
+
+	private:
+		std::size_t           m_numRows;
+		std::size_t           m_numCols;
+		std::vector<uint64_t> m_rowStart;
+		std::vector<uint32_t> m_columns;
+		std::vector<float>    m_values;
+	};
+
+	///
+	/// \brief Cached screen resolution aggregation of a sparse matrix for Window::drawSparse.
+	///
+	/// Pixel grid is snapped to whole pixels of the current zoom level, so that panning reuses the aggregated
+	/// pixels and recomputes only the newly exposed strips. Nothing is recomputed or uploaded, when the view
+	/// does not change.
+	///
+	class SparsePlot {
+	public:
+		explicit SparsePlot(const SparseMatrix& matrix, Aggregate mode = Aggregate::COUNT);
+		~SparsePlot();
+
+		void setMode(Aggregate mode) { if(mode != m_mode) { m_mode = mode; m_valid = false; } }
+		// Call, if the matrix changes.
+		void invalidate() { m_valid = false; }
+
+		// Updates pixels for view. Returns number of recomputed pixels.
+		std::size_t update(float left, float right, float bottom, float top, int width, int height);
+
+		const std::vector<float>& getPixels() const { return m_pixels; }
+		const PixelGrid& getGrid() const { return m_grid; }
+
+	private:
+		friend class Window;
+		SparsePlot(const SparsePlot&) = delete;
+		SparsePlot& operator=(const SparsePlot&) = delete;
+
+		const SparseMatrix*      m_matrix;
+		Aggregate                m_mode;
+		PixelGrid                m_grid;
+		std::vector<float>       m_pixels;
+		bool                     m_valid;
+		bool                     m_uploaded;
+		std::shared_ptr<Texture> m_texture;
+	};
+
+}
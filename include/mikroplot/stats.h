@@ -0,0 +1,134 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <mikroplot/window.h>
+#include <vector>
+#include <deque>
+#include <utility>
+
+namespace mikroplot {
+
+	///
+	/// \brief KLL quantile sketch.
+	///
+	/// Keeps O(k log(n/k)) samples in levels, where item at level h represents 2^h inputs. Rank error is
+	/// about 1.7/k. Adding is amortized O(1) and sketches can be merged.
+	///
+	class QuantileSketch {
+	public:
+		explicit QuantileSketch(std::size_t k = 200);
+
+		void add(float value);
+		void merge(const QuantileSketch& other);
+		void clear();
+
+		// Returns approximate q-quantile, q in [0,1]. NaN if sketch is empty.
+		float quantile(float q) const;
+		std::size_t getCount() const { return m_count; }
+
+	private:
+		std::size_t capacity(std::size_t level) const { return m_capacities[level]; }
+		void updateCapacity();
+		void compress();
+
+		std::size_t                       m_k;
+		std::size_t                       m_count;
+		std::size_t                       m_size;
+		bool                              m_coin;
+		std::vector< std::vector<float> > m_levels;
+		std::vector<std::size_t>          m_capacities;
+		std::size_t                       m_totalCapacity;
+	};
+
+	struct StatsOptions {
+		std::size_t        windowSize = 1000;			// Number of latest samples in the rolling window.
+		std::size_t        outputInterval = 1;			// Output point is appended every outputInterval samples.
+		std::vector<float> quantiles = {0.5f, 0.99f};	// Rolling quantiles.
+		std::size_t        sketchSize = 200;			// k of quantile sketches.
+		std::size_t        maxPoints = 0;				// Maximum number of output points kept. 0 = unlimited.
+	};
+
+	///
+	/// \brief Incremental rolling statistics of a streaming series.
+	///
+	/// Min and max use monotonic deques and mean and variance use Welford updates with removal, so they are
+	/// exact over the window with O(1) amortized cost per sample. Quantiles use KLL sketches of 8 panes of the
+	/// window. Output quantiles are evaluated from the completed panes, when a pane is completed, so they
+	/// slide in steps of windowSize/8 samples.
+	///
+	/// Outputs are line strips, which can be drawn with drawLines and drawBand. NaN samples are skipped: they
+	/// are not part of the window and produce no output.
+	///
+	class StreamingStats {
+	public:
+		explicit StreamingStats(const StatsOptions& options = StatsOptions());
+
+		void add(float x, float value);
+		void add(const std::vector<vec2>& samples);
+
+		// Statistics of the current window.
+		std::size_t getWindowCount() const { return m_window.size(); }
+		float getMean() const { return float(m_mean); }
+		float getVariance() const;
+		float getStdDev() const;
+		float getMin() const;
+		float getMax() const;
+		float getQuantile(float q) const;
+
+		// Output lines.
+		const std::vector<vec2>& getMeanLine() const { return m_meanLine; }
+		const std::vector<vec2>& getLowerStdLine() const { return m_lowerStdLine; }	// mean - stddev
+		const std::vector<vec2>& getUpperStdLine() const { return m_upperStdLine; }	// mean + stddev
+		const std::vector<vec2>& getMinLine() const { return m_minLine; }
+		const std::vector<vec2>& getMaxLine() const { return m_maxLine; }
+		// Line of options.quantiles[index].
+		const std::vector<vec2>& getQuantileLine(std::size_t index) const { return m_quantileLines[index]; }
+
+	private:
+		void output(float x);
+		QuantileSketch mergePanes(std::size_t numPanes) const;
+
+		StatsOptions                              m_options;
+		std::deque<float>                         m_window;
+		std::size_t                               m_numSamples;
+		double                                    m_mean;
+		double                                    m_m2;
+		std::deque< std::pair<std::size_t,float> > m_minDeque;
+		std::deque< std::pair<std::size_t,float> > m_maxDeque;
+		std::deque<QuantileSketch>                m_panes;
+		std::size_t                               m_paneSize;
+		std::vector<float>                        m_paneQuantiles;	// Quantiles of completed panes.
+
+		std::vector<vec2>                         m_meanLine;
+		std::vector<vec2>                         m_lowerStdLine;
+		std::vector<vec2>                         m_upperStdLine;
+		std::vector<vec2>                         m_minLine;
+		std::vector<vec2>                         m_maxLine;
+		std::vector< std::vector<vec2> >          m_quantileLines;
+	};
+
+}
@@ -0,0 +1,78 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#pragma once
+#include <vector>
+#include <stdint.h>
+
+namespace mikroplot {
+
+	///
+	/// \brief Multi-channel sample history in a GPU ring buffer, for scrolling oscilloscope style plots.
+	///
+	/// Samples are stored frame by frame (numChannels values per frame) in a texture buffer. Appending
+	/// uploads only the new frames. Window::drawStreamingSeries fetches the samples in the vertex shader,
+	/// handling the ring buffer wrap-around and computing the x coordinates, so drawing costs no CPU work.
+	///
+	/// Frame n (counted from the first appended frame) is located at x = n*sampleInterval.
+	///
+	class StreamingSeries {
+	public:
+		// Throws std::runtime_error, if capacity*numChannels exceeds GL_MAX_TEXTURE_BUFFER_SIZE.
+		StreamingSeries(std::size_t numChannels, std::size_t capacity, double sampleInterval = 1.0);
+		~StreamingSeries();
+
+		// Appends interleaved frames: numFrames*numChannels values.
+		void append(const float* frames, std::size_t numFrames);
+		void append(const std::vector<float>& frames) {
+			append(frames.data(), frames.size() / m_numChannels);
+		}
+
+		std::size_t getNumChannels() const { return m_numChannels; }
+		std::size_t getCapacity() const { return m_capacity; }
+		// Number of frames in the buffer.
+		std::size_t getSize() const { return m_totalFrames < m_capacity ? std::size_t(m_totalFrames) : m_capacity; }
+		uint64_t getTotalFrames() const { return m_totalFrames; }
+		double getSampleInterval() const { return m_sampleInterval; }
+		// X coordinate of the newest frame.
+		double getLatestX() const { return m_totalFrames > 0 ? double(m_totalFrames-1)*m_sampleInterval : 0.0; }
+
+	private:
+		friend class Window;
+		StreamingSeries(const StreamingSeries&) = delete;
+		StreamingSeries& operator=(const StreamingSeries&) = delete;
+		void upload(std::size_t ringIndex, const float* frames, std::size_t numFrames);
+
+		std::size_t  m_numChannels;
+		std::size_t  m_capacity;
+		double       m_sampleInterval;
+		uint64_t     m_totalFrames;
+		std::size_t  m_head;	// Ring index of the next frame
+		uint32_t     m_buffer;
+		uint32_t     m_texture;
+	};
+
+}
@@ -38,6 +38,10 @@ namespace mikroplot {
 		Texture(int width, int height, bool isDepthTexture);
 		~Texture();
 
+		// Updates rectangle of the texture (glTexSubImage2D). Data is tightly packed rows of width*nrChannels bytes.
+		void setSubData(int x, int y, int width, int height, int nrChannels, const uint8_t* data);
+		void setSubData(int x, int y, int width, int height, int nrChannels, const float* data);
+
 		uint32_t getTextureId() const;
 		auto getWidth() const {return m_width;}
 		auto getHeight() const {return m_height;}
@@ -35,6 +35,14 @@
 #include <map>
 #include <array>
 #include <mikroplot/texture.h>
+#include <mikroplot/jobs.h>
+#include <mikroplot/sampling.h>
+#include <mikroplot/column.h>
+#include <mikroplot/range.h>
+#include <mikroplot/density.h>
+#include <mikroplot/poster.h>
+#include <mikroplot/feedback.h>
+#include <mikroplot/progressive.h>
 
 struct GLFWwindow;
 
@@ -85,15 +93,18 @@ namespace mikroplot {
 		"return vec4(iterations/maxIters,n.x,n.y,0.9);}";
 	}
 
+	// Generates M rows of N values. Rows are generated in parallel, so f(x,y) must be thread safe.
 	template<typename T,typename F>
 	inline auto genNM(F f, std::size_t N, std::size_t M) {
-		std::vector< std::vector<T> > res;
-		for(std::size_t i=0; i<M; ++i) {
-			res.push_back(std::vector<T>());
-			for(std::size_t j=0; j<N; ++j) {
-				res[i].push_back(f(j,i));
+		std::vector< std::vector<T> > res(M);
+		JobSystem::get().parallelFor("genNM", 0, M, std::max<std::size_t>(1, 16384 / std::max<std::size_t>(1, N)), [&](std::size_t begin, std::size_t end) {
+			for(std::size_t i=begin; i<end; ++i) {
+				res[i].reserve(N);
+				for(std::size_t j=0; j<N; ++j) {
+					res[i].push_back(f(j,i));
+				}
 			}
-		}
+		});
 		return res;
 	}
 
@@ -151,10 +162,24 @@ namespace mikroplot {
 		float x;
 		float y;
 
+		vec2() : x(0), y(0) {}
 		vec2(float xvalue, float yvalue) : x(xvalue), y(yvalue) {}
 		vec2(const std::vector<float>& v) : x(v[0]), y(v[1]) { assert(v.size() == 2); }
 	};
 
+	///
+	/// \brief Samples of a function plot, which are reused as long as the view does not change.
+	///
+	/// Call invalidate(), if the function itself changes.
+	struct FunctionCache {
+		std::vector<vec2>   points;
+		std::array<float,4> view = {0,0,0,0};	// left, right, bottom, top sampled: part of the view in the framebuffer
+		std::array<int,2>   pixels = {0,0};		// framebuffer width, height
+		bool                valid = false;
+
+		void invalidate() { valid = false; }
+	};
+
 	// Specify default-palette:
 	const std::vector<RGBA> MIKROPLOT_DEFAULT_PALETTE = {
 		RGBA(0x00,0x00,0x00,0x00),	// 0  = Transparent black
@@ -203,6 +228,35 @@ namespace mikroplot {
 	class FrameBuffer;
 	class Texture;
 	class Shader;
+	class DirtyGrid;
+	class SeriesPyramid;
+	class StreamingSeries;
+	class SeriesHistory;
+	class PointIndex;
+	class PointQuadtree;
+	class Histogram;
+	class Contours;
+	class GraphLayout;
+	class SparsePlot;
+	class AmrField;
+	class RasterPyramid;
+	namespace clip { enum class Primitive; }
+
+	///
+	/// \brief Statistics of a single frame.
+	struct FrameStats {
+		std::size_t textureUploads = 0;		// Number of texture (sub)uploads
+		std::size_t textureUploadBytes = 0;	// Bytes uploaded to textures
+		std::size_t vertices = 0;			// Number of line and point vertices drawn
+	};
+
+	///
+	/// \brief Decimation mode of line strips drawn with drawLines.
+	enum class Decimation {
+		NONE,	// Draw all points.
+		M4,		// Min, max, first and last point per pixel column. Pixel identical result. X must be sorted.
+		LTTB	// Largest-Triangle-Three-Buckets downsampling to two points per pixel column. X must be sorted.
+	};
 
 
 	class Timer {
@@ -252,10 +306,23 @@ namespace mikroplot {
 		int getKeyState(int keyCode) const;
 		int getKeyPressed(int keyCode) const;
 		int getKeyReleased(int keyCode) const;
+		// Returns mouse cursor position in data coordinates (screen coordinates minus offset).
+		vec2 getMousePosition() const;
+		// Returns index of the point nearest to the mouse cursor within maxPixels, or -1.
+		std::ptrdiff_t pick(const PointIndex& index, float maxPixels = 8.0f) const;
 
 		int update();
 		int run();
+		// Returns statistics of the previous frame (the one finished by last update() call).
+		const FrameStats& getStats() const { return m_lastStats; }
 		void screenshot(const std::string filename);
+		// Renders the scene tile by tile to a PNG image of width x height pixels, which may be larger than the window
+		// and the largest framebuffer. drawScene draws one frame, as between update() calls, and is called once per tile.
+		// Line widths and point sizes are in image pixels. Layers computed per screen pixel (drawDensity, drawSparse,
+		// decimated lines) are computed for each tile over its part of the view at the image resolution, so their
+		// automatic ranges are per tile. Returns false, if the file could not be written.
+		bool exportPoster(const std::string& fileName, int width, int height, const std::function<void()>& drawScene,
+						  const PosterOptions& options = PosterOptions());
 		bool shouldClose();
 
 		// Screen settings
@@ -275,7 +342,9 @@ namespace mikroplot {
 
 		// Sets clear color
 		void setClearColor(int color=4) { m_clearColor = color; }
-		void setPalette(const std::vector<RGBA>& palette) { m_palette = palette; }
+		void setPalette(const std::vector<RGBA>& palette) { m_palette = palette; ++m_paletteVersion; }
+		// Sets decimation mode of line strips. Decimation is applied, when there are more points than pixel columns.
+		void setDecimation(Decimation mode) { m_decimation = mode; }
 		// Sets coortinate offset
 		void setOffset(const std::array<float,2>& offset) { m_offset = offset; }
 
@@ -283,6 +352,25 @@ namespace mikroplot {
 		void drawAxis(int thickColor=6, int thinColor=5, int thick=3, int thin=1);
 		void drawLines(const std::vector<vec2>& lines, int color=DEFAULT_COLOR, std::size_t lineWidth = 2, bool drawStrips=true);
 		void drawPoints(const std::vector<vec2>& points, int color=DEFAULT_COLOR, std::size_t pointSize = 2);
+		// Draws points and line strips straight from column views (for example columns of memory mapped ArrayFile).
+		void drawLines(const ColumnView& x, const ColumnView& y, int color=DEFAULT_COLOR, std::size_t lineWidth = 2);
+		void drawPoints(const ColumnView& x, const ColumnView& y, int color=DEFAULT_COLOR, std::size_t pointSize = 2);
+		// Draws bars of histogram with one instanced draw call. Density scales bars to unit area over the bins, ignoring underflow and overflow.
+		void drawHistogram(const Histogram& histogram, int color=DEFAULT_COLOR, bool density=false, float barWidth=0.9f);
+		// Bins values on the GPU with additive blending and adds counts to histogram. Values are uploaded in chunks of 16M.
+		void binHistogram(Histogram& histogram, const float* values, std::size_t count);
+		// Draws edges with one indexed draw and nodes with one draw from GPU buffers. Positions are uploaded only when changed.
+		void drawGraph(GraphLayout& graph, int nodeColor=DEFAULT_COLOR, int edgeColor=DEFAULT_COLOR, std::size_t pointSize = 3, std::size_t lineWidth = 1);
+		// Fills area between two lines with same x coordinates, for example min/max or quantile bands of StreamingStats.
+		void drawBand(const std::vector<vec2>& lower, const std::vector<vec2>& upper, int color=DEFAULT_COLOR, float opacity = 0.3f);
+		// Draws visible nodes of quadtree, with node samples where there are more points than pixels.
+		void drawPoints(const PointQuadtree& points, int color=DEFAULT_COLOR, std::size_t pointSize = 2, float pointsPerPixel = 1.0f);
+		// Draws visible range of indexed series as min/max line strip with two points per pixel column.
+		void drawSeries(const SeriesPyramid& series, int color=DEFAULT_COLOR, std::size_t lineWidth = 2);
+		// Draws visible frames of one channel of streaming series. Samples are read from GPU ring buffer.
+		void drawStreamingSeries(const StreamingSeries& series, std::size_t channel, int color=DEFAULT_COLOR, std::size_t lineWidth = 2);
+		// Draws visible range of compressed history. Only visible blocks are decoded.
+		void drawHistory(const SeriesHistory& history, int color=DEFAULT_COLOR, std::size_t lineWidth = 2);
 		void drawCircle(const vec2& position, float radius, int color=DEFAULT_COLOR, std::size_t lineWidth = 2, std::size_t numSegments = 50);
 
 		void drawSprite(const std::vector< std::vector<float> >& transform, const Grid& pixels, const std::string& surfaceShader="", const std::string& globals="");
@@ -290,13 +378,77 @@ namespace mikroplot {
 		void drawSprite(const std::vector< std::vector<float> >& transform, const mikroplot::Texture* texture, const std::string& surfaceShader="", const std::string& globals="");
 
 		void drawFunction(const std::function<float(float)>& f, int color=DEFAULT_COLOR, std::size_t lineWidth = 2);
+		// Draws y=f(x) using adaptive sampling. Samples are evaluated in parallel, if options.parallel is set (f must be thread safe).
+		template<typename F>
+		void drawFunction(const F& f, int color=DEFAULT_COLOR, std::size_t lineWidth = 2, const SamplingOptions& options = SamplingOptions()) {
+			std::vector<vec2> points;
+			auto view = functionView();
+			sampling::adaptive(points, f, view[0], view[1], view[2], view[3], m_framebufferWidth, m_framebufferHeight, options);
+			drawLines(points, color, lineWidth);
+		}
+		// Draws y=f(x) using adaptive sampling. Samples are taken again only, if the view or the cache has been changed.
+		template<typename F>
+		void drawFunction(FunctionCache& cache, const F& f, int color=DEFAULT_COLOR, std::size_t lineWidth = 2, const SamplingOptions& options = SamplingOptions()) {
+			auto view = functionView();
+			std::array<int,2> pixels = {m_framebufferWidth, m_framebufferHeight};
+			if(!cache.valid || cache.view != view || cache.pixels != pixels) {
+				sampling::adaptive(cache.points, f, view[0], view[1], view[2], view[3], m_framebufferWidth, m_framebufferHeight, options);
+				cache.view = view;
+				cache.pixels = pixels;
+				cache.valid = true;
+			}
+			drawLines(cache.points, color, lineWidth);
+		}
+		///
+		/// \brief Draws y=expression evaluated on GPU. One sample is taken per pixel column of the current screen.
+		///
+		/// Expression is GLSL and can use variable x, given constants and functions defined in globals. When numInstances > 1,
+		/// the curve is drawn numInstances times with single instanced draw call and instance (0...numInstances-1) and
+		/// numInstances can be used as curve parameters in expression.
+		void drawFunctionGLSL(const std::string& expression, const std::vector<Constant>& inputConstants = {}, int color=DEFAULT_COLOR,
+							  std::size_t lineWidth = 2, std::size_t numInstances = 1, const std::string& globals="");
 		void drawPixels(const Grid& pixels);
+		// Draws grid from persistent texture. Only dirty regions of the grid are uploaded.
+		void drawPixels(DirtyGrid& pixels);
 		void drawRGB(const RGBAMap& map);
 		void drawRGB(int width, int height, std::vector<unsigned char> rgb);
 		void drawHeatMap(const HeatMap& pixels, const float valueMin=0.0f, float valueMax=1.0f);
+		// Draws contours on top of heat map of the same field. Level i uses colors[i % colors.size()]. One draw call per level
+		// from a vertex buffer, which is uploaded only when the contours have been recomputed.
+		void drawContours(Contours& contours, const std::vector<int>& colors = {DEFAULT_COLOR}, std::size_t lineWidth = 1);
+		// Draws heat map with automatic range. Values are uploaded as floats and mapped to colors on the GPU. Returns used range.
+		ValueRange drawHeatMap(const HeatMap& pixels, const RangeOptions& options);
+		// Draws number of points per pixel with colors, where drawPoints would draw an opaque blob. Points are streamed in
+		// chunks. Returns range of nonzero counts. With useGPU the range is from the counts of the previous GPU drawDensity
+		// (one frame of latency), except on the first frame of each size.
+		ValueRange drawDensity(const std::vector<vec2>& points, const DensityOptions& options = DensityOptions());
+		ValueRange drawDensity(const ColumnView& x, const ColumnView& y, const DensityOptions& options = DensityOptions());
+		// Draws AMR patches with automatic range, finest level on top. Patches fitting inside minPixels are culled. Returns used range.
+		ValueRange drawAmr(AmrField& field, const RangeOptions& options = RangeOptions(), float minPixels = 1.0f);
+		// Draws visible tiles of a raster pyramid at the current zoom level, while missing tiles are loaded in the background.
+		// Range is taken from the coarsest level. Returns used range.
+		ValueRange drawRaster(RasterPyramid& raster, const RangeOptions& options = RangeOptions());
+		// Draws sparse matrix aggregated to screen pixels. Only pixels exposed by panning are recomputed. Returns used range.
+		ValueRange drawSparse(SparsePlot& plot, const RangeOptions& options = RangeOptions());
 
 		void shade(const std::string& fragmentShader, const std::string& globals="");
 		void shade(const std::vector<Constant>& inputConstants, const std::string& fragmentShader, const std::string& globals="");
+		// Shades progressively: renders only the tiles fitting options.budgetMilliseconds of GPU time per frame. Tiles accumulate
+		// in progressive while the shader, constants and view stay the same, so expensive shaders refine the image over frames.
+		void shade(ProgressiveShade& progressive, const std::vector<Constant>& inputConstants, const std::string& fragmentShader,
+				   const std::string& globals="", const ProgressiveOptions& options = ProgressiveOptions());
+		///
+		/// \brief Advances simulation by steps on the GPU. Each step renders the next state of every cell from the previous state.
+		///
+		/// fragmentShaderMain sets color, the next state of the cell, which is the previous state at start. It can read
+		/// neighbors with state(dx, dy) and use cell, uv, iteration (number of steps before this one) and given constants.
+		void simulate(Feedback& feedback, int steps, const std::vector<Constant>& inputConstants, const std::string& fragmentShaderMain,
+					  const std::string& globals="");
+		// Draws state over the screen. surfaceShader can map color, which is the state of the cell, as in drawSprite.
+		void drawFeedback(Feedback& feedback, const std::vector<Constant>& inputConstants = {}, const std::string& surfaceShader = "",
+						  const std::string& globals="");
+		// Draws first channel of the state with heat map colors.
+		void drawFeedback(Feedback& feedback, const ValueRange& range);
 
 		void playSound(const std::string& fileName);
 
@@ -358,27 +510,75 @@ namespace mikroplot {
 		Window(const Window&) = delete;
 		Window& operator=(const Window&) = delete;
 		void drawScreenSizeQuad(Texture* texture);
+		// Part of the view in the framebuffer without offset: left, right, bottom, top, where functions are sampled.
+		std::array<float,4> functionView() const {
+			return {m_frameLeft - m_offset[0], m_frameRight - m_offset[0], m_frameBottom - m_offset[1], m_frameTop - m_offset[1]};
+		}
+		// Maps single channel float texture to colors over the screen with the heat map shader.
+		void drawValueTexture(const Texture& texture, const ValueRange& range, bool logScale = false, bool skipZero = false);
+		// Same for texture of framebuffer pixels over m_frameLeft ... m_frameTop (drawDensity, drawSparse).
+		void drawFrameValueTexture(const Texture& texture, const ValueRange& range, bool logScale = false, bool skipZero = false);
+		// Same for geometry drawn by draw(shader), which is transformed with vertexShader.
+		void drawValueTexture(const Texture& texture, const ValueRange& range, const std::string& vertexShader, const std::function<void(Shader&)>& draw,
+							  bool logScale = false, bool skipZero = false);
+		// Counts points per pixel with bin or by splatting chunks returned by chunk(begin, end, scratch) and draws the counts.
+		ValueRange drawDensity(std::size_t count, const DensityOptions& options, const std::function<void(float* counts)>& bin,
+							   const std::function<const vec2*(std::size_t begin, std::size_t end, std::vector<vec2>& scratch)>& chunk);
+		void drawLines(const vec2* lines, std::size_t count, int color, std::size_t lineWidth, bool drawStrips);
+		void drawPoints(const vec2* points, std::size_t count, int color, std::size_t pointSize);
+		// Returns runs of points touching the view expanded by marginPx pixels. Small arrays are returned as one run.
+		std::vector< std::pair<std::size_t, std::size_t> > visibleRuns(const vec2* points, std::size_t count, clip::Primitive primitive, std::size_t marginPx) const;
+		void countUpload(std::size_t bytes);
+		// Sets view and constant uniforms of a shade shader.
+		void setShadeUniforms(Shader& shader, const std::vector<Constant>& inputConstants);
+		// Creates framebuffers of feedback and uploads state set by setState.
+		void prepareFeedback(Feedback& feedback);
+		// Returns compiled shader from cache or compiles new one.
+		Shader& getShader(const std::string& vertexShader, const std::string& fragmentShader);
 		void drawSprite(const std::vector<float>& M, const Texture* texture, const std::vector<Constant>& inputConstants, const std::string& surfaceShader, const std::string& globals);
 		void takeScreenshot(const std::string filename);
+		// Sets glOrtho, m_projection and m_ortho from the screen rectangle and the poster tile.
+		void updateProjection();
 
 		int								m_clearColor;
 		std::array<float,2>				m_offset;
 		int								m_width;
 		int								m_height;
+		int								m_framebufferWidth;
+		int								m_framebufferHeight;
 		std::vector<RGBA>				m_palette;
+		uint32_t						m_paletteVersion;
+		Decimation						m_decimation;
+		FrameStats						m_stats;
+		FrameStats						m_lastStats;
 		std::map<std::string, std::shared_ptr<mikroplot::Texture> >	m_textures;
 		GLFWwindow*                     m_window;
 
 		std::vector<float> m_projection;
+		std::vector<float> m_ortho;	// Projection including translation, same as the glOrtho of the fixed pipeline.
+		std::vector<float> m_frameProjection;	// m_projection without the poster tile transform: screen size quad covers the framebuffer.
 		float                           m_left;
 		float                           m_right;
 		float                           m_bottom;
 		float                           m_top;
+		std::array<float,4>             m_tile;	// Scale and offset of normalized device coordinates while rendering a poster tile.
+		float                           m_frameLeft;	// Part of the view in the framebuffer: the view, or its part in the poster tile.
+		float                           m_frameRight;
+		float                           m_frameBottom;
+		float                           m_frameTop;
+		float                           m_pixelScale;	// Multiplier of line widths and point sizes (poster supersampling).
 
 		std::unique_ptr<FrameBuffer>    m_shadeFbo;
+		std::unique_ptr<FrameBuffer>    m_densityFbo;	// Float point counts for drawDensity, created on first use.
+		unsigned int                    m_densityPbo;	// Pixel pack buffer of the counts, read back for the range of the next frame.
+		bool                            m_densityPending;	// m_densityPbo has counts of m_densityFbo size.
 		std::unique_ptr<Shader>         m_ssqShader;
 		std::unique_ptr<mesh::Mesh>     m_ssq;
 		std::unique_ptr<mesh::Mesh>     m_sprite;
+		unsigned int                    m_emptyVao;
+		unsigned int                    m_barBuffer;	// Texture buffer of bar heights for drawHistogram.
+		unsigned int                    m_barTexture;
+		std::map<std::string, std::unique_ptr<Shader> >	m_shaders;
 		std::string                     m_screenshotFileName;
 
 		std::map<int, bool>         m_prevKeys;
@@ -0,0 +1,170 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/amr.h>
+#include <mikroplot/jobs.h>
+#include <mikroplot/texture.h>
+#include <mikroplot/GLUtils.h>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <cassert>
+
+namespace mikroplot {
+
+AmrField::AmrField()
+	: m_atlasWidth(0)
+	, m_atlasHeight(0)
+	, m_numPages(0)
+	, m_packed(true)
+	, m_version(0)
+	, m_uploadedVersion(0)
+	, m_vao(0)
+	, m_vertexBuffer(0) {
+}
+
+AmrField::~AmrField() {
+	if(m_vao != 0) {
+		glDeleteVertexArrays(1, &m_vao);
+		glDeleteBuffers(1, &m_vertexBuffer);
+	}
+}
+
+std::size_t AmrField::addPatch(const AmrPatch& patch) {
+	assert(patch.values.size() == patch.width*patch.height);
+	m_patches.push_back(patch);
+	m_dirty.push_back(0);
+	// Keep draw order sorted by level, patches of the same level in the order they were added.
+	auto position = std::upper_bound(m_drawOrder.begin(), m_drawOrder.end(), patch.level, [&](int level, std::size_t index) {
+		return level < m_patches[index].level;
+	});
+	m_drawOrder.insert(position, m_patches.size() - 1);
+	m_packed = false;
+	++m_version;
+	return m_patches.size() - 1;
+}
+
+void AmrField::setValues(std::size_t patch, const std::vector<float>& values) {
+	assert(patch < m_patches.size());
+	assert(values.size() == m_patches[patch].values.size());
+	m_patches[patch].values = values;
+	m_dirty[patch] = 1;
+	++m_version;
+}
+
+void AmrField::clear() {
+	m_patches.clear();
+	m_dirty.clear();
+	m_drawOrder.clear();
+	m_packed = false;
+	++m_version;
+}
+
+void AmrField::pack(int maxSize) {
+	// Shelf packing of patches from the highest to the lowest. A new page is started when a shelf does not fit.
+	std::vector<std::size_t> byHeight(m_drawOrder);
+	std::sort(byHeight.begin(), byHeight.end(), [&](std::size_t a, std::size_t b) {
+		return m_patches[a].height > m_patches[b].height;
+	});
+	std::size_t area = 0;
+	std::size_t maxWidth = 1;
+	for(auto& patch : m_patches) {
+		if(patch.width > std::size_t(maxSize) || patch.height > std::size_t(maxSize)) {
+			throw std::runtime_error("AMR patch of " + std::to_string(patch.width) + "x" + std::to_string(patch.height)
+				+ " values is larger than maximum texture size " + std::to_string(maxSize));
+		}
+		area += patch.width*patch.height;
+		maxWidth = std::max(maxWidth, patch.width);
+	}
+	int width = 1;
+	while(width < maxSize && std::size_t(width)*std::size_t(width) < area) {
+		width *= 2;
+	}
+	width = std::max(width, int(maxWidth));
+	m_placements.assign(m_patches.size(), Placement{0, 0, 0});
+	int page = 0;
+	int x = 0;
+	int y = 0;
+	int shelfHeight = 0;
+	int height = 1;
+	for(auto index : byHeight) {
+		const auto& patch = m_patches[index];
+		if(x + int(patch.width) > width) {
+			x = 0;
+			y += shelfHeight;
+			shelfHeight = 0;
+		}
+		if(y + int(patch.height) > maxSize) {
+			++page;
+			x = 0;
+			y = 0;
+			shelfHeight = 0;
+		}
+		m_placements[index] = Placement{page, x, y};
+		x += int(patch.width);
+		shelfHeight = std::max(shelfHeight, int(patch.height));
+		height = std::max(height, y + shelfHeight);
+	}
+	m_atlasWidth = width;
+	m_atlasHeight = height;
+	m_numPages = page + 1;
+	m_packed = true;
+}
+
+std::vector<float> AmrField::atlasValues() const {
+	const std::size_t pageSize = std::size_t(m_atlasWidth)*std::size_t(m_atlasHeight);
+	std::vector<float> atlas(std::size_t(m_numPages)*pageSize, std::numeric_limits<float>::quiet_NaN());
+	JobSystem::get().parallelFor("AmrField::atlas", 0, m_patches.size(), 16, [&](std::size_t begin, std::size_t end) {
+		for(std::size_t i=begin; i<end; ++i) {
+			const auto& patch = m_patches[i];
+			const auto& placement = m_placements[i];
+			for(std::size_t row=0; row<patch.height; ++row) {
+				std::copy_n(&patch.values[row*patch.width], patch.width,
+					&atlas[std::size_t(placement.page)*pageSize + (std::size_t(placement.y) + row)*std::size_t(m_atlasWidth) + std::size_t(placement.x)]);
+			}
+		}
+	});
+	return atlas;
+}
+
+std::vector<std::size_t> AmrField::visiblePatches(float left, float right, float bottom, float top, float pixelsPerUnitX, float pixelsPerUnitY, float minPixels) const {
+	std::vector<std::size_t> result;
+	for(auto index : m_drawOrder) {
+		const auto& patch = m_patches[index];
+		if(patch.right < left || patch.left > right || patch.top < bottom || patch.bottom > top) {
+			continue;
+		}
+		if(std::max((patch.right - patch.left) * pixelsPerUnitX, (patch.top - patch.bottom) * pixelsPerUnitY) < minPixels) {
+			continue;
+		}
+		result.push_back(index);
+	}
+	return result;
+}
+
+}
@@ -0,0 +1,114 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/clip.h>
+#include <mikroplot/jobs.h>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIKROPLOT_SSE2 1
+#endif
+
+namespace mikroplot {
+
+namespace clip {
+
+namespace {
+	const std::size_t OUTCODE_GRAIN = 65536;
+
+	inline uint8_t outcode(const vec2& p, float left, float right, float bottom, float top) {
+		return uint8_t((p.x < left ? LEFT : 0) | (p.x > right ? RIGHT : 0) | (p.y < bottom ? BOTTOM : 0) | (p.y > top ? TOP : 0));
+	}
+}
+
+void outcodes(const vec2* points, std::size_t count, float left, float right, float bottom, float top, uint8_t* codes) {
+	JobSystem::get().parallelFor("clip::outcodes", 0, count, OUTCODE_GRAIN, [&](std::size_t begin, std::size_t end) {
+		std::size_t i = begin;
+#if defined(MIKROPLOT_SSE2)
+		// Two points (x0,y0,x1,y1) per register: compare against (left,bottom,left,bottom) and (right,top,right,top).
+		const __m128 mins = _mm_setr_ps(left, bottom, left, bottom);
+		const __m128 maxs = _mm_setr_ps(right, top, right, top);
+		for(; i+4 <= end; i += 4) {
+			__m128 a = _mm_loadu_ps(&points[i].x);
+			__m128 b = _mm_loadu_ps(&points[i+2].x);
+			int lowA = _mm_movemask_ps(_mm_cmplt_ps(a, mins));
+			int highA = _mm_movemask_ps(_mm_cmpgt_ps(a, maxs));
+			int lowB = _mm_movemask_ps(_mm_cmplt_ps(b, mins));
+			int highB = _mm_movemask_ps(_mm_cmpgt_ps(b, maxs));
+			// Mask bits: 0 = x0, 1 = y0, 2 = x1, 3 = y1.
+			codes[i+0] = uint8_t(((lowA >> 0) & 1) * LEFT | ((highA >> 0) & 1) * RIGHT | ((lowA >> 1) & 1) * BOTTOM | ((highA >> 1) & 1) * TOP);
+			codes[i+1] = uint8_t(((lowA >> 2) & 1) * LEFT | ((highA >> 2) & 1) * RIGHT | ((lowA >> 3) & 1) * BOTTOM | ((highA >> 3) & 1) * TOP);
+			codes[i+2] = uint8_t(((lowB >> 0) & 1) * LEFT | ((highB >> 0) & 1) * RIGHT | ((lowB >> 1) & 1) * BOTTOM | ((highB >> 1) & 1) * TOP);
+			codes[i+3] = uint8_t(((lowB >> 2) & 1) * LEFT | ((highB >> 2) & 1) * RIGHT | ((lowB >> 3) & 1) * BOTTOM | ((highB >> 3) & 1) * TOP);
+		}
+#endif
+		for(; i<end; ++i) {
+			codes[i] = outcode(points[i], left, right, bottom, top);
+		}
+	});
+}
+
+std::vector< std::pair<std::size_t, std::size_t> > visibleRuns(const vec2* points, std::size_t count, Primitive primitive, float left, float right, float bottom, float top) {
+	std::vector< std::pair<std::size_t, std::size_t> > runs;
+	std::vector<uint8_t> codes(count);
+	outcodes(points, count, left, right, bottom, top, codes.data());
+
+	auto add = [&](std::size_t begin, std::size_t end) {
+		if(!runs.empty() && runs.back().second >= begin) {
+			runs.back().second = std::max(runs.back().second, end);
+		} else {
+			runs.push_back({begin, end});
+		}
+	};
+	switch(primitive) {
+	case Primitive::POINTS:
+		for(std::size_t i=0; i<count; ++i) {
+			if(codes[i] == 0) add(i, i+1);
+		}
+		break;
+	case Primitive::LINES:
+		for(std::size_t i=0; i+1<count; i += 2) {
+			if((codes[i] & codes[i+1]) == 0) add(i, i+2);
+		}
+		break;
+	case Primitive::LINE_STRIP:
+		// Segments share points, so visible segments i and i+1 join into one run.
+		for(std::size_t i=0; i+1<count; ++i) {
+			if((codes[i] & codes[i+1]) == 0) {
+				if(!runs.empty() && runs.back().second == i+1) {
+					runs.back().second = i+2;
+				} else {
+					runs.push_back({i, i+2});
+				}
+			}
+		}
+		break;
+	}
+	return runs;
+}
+
+}
+
+}
@@ -0,0 +1,276 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/contour.h>
+#include <mikroplot/jobs.h>
+#include <mikroplot/GLUtils.h>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <array>
+
+namespace mikroplot {
+
+namespace {
+	typedef std::vector<uint64_t> Chain;	// Edge ids along polyline.
+
+	// Edge ids: horizontal edge (x,y)-(x+1,y) is 2*(y*width+x), vertical edge (x,y)-(x,y+1) is 2*(y*width+x)+1.
+	inline uint64_t horizontalEdge(std::size_t x, std::size_t y, std::size_t width) {
+		return 2*(uint64_t(y)*width + x);
+	}
+
+	inline uint64_t verticalEdge(std::size_t x, std::size_t y, std::size_t width) {
+		return 2*(uint64_t(y)*width + x) + 1;
+	}
+
+	// Segments of marching squares cases as pairs of cell edges: 0 = bottom, 1 = right, 2 = top, 3 = left.
+	// Saddles 5 and 10 are listed for the center below the level; for the center above, see SADDLES.
+	const int8_t CASES[16][4] = {
+		{-1,-1,-1,-1}, {3,0,-1,-1}, {0,1,-1,-1}, {3,1,-1,-1},
+		{1,2,-1,-1},   {3,0,1,2},   {0,2,-1,-1}, {3,2,-1,-1},
+		{2,3,-1,-1},   {0,2,-1,-1}, {0,1,2,3},   {1,2,-1,-1},
+		{1,3,-1,-1},   {0,1,-1,-1}, {3,0,-1,-1}, {-1,-1,-1,-1}
+	};
+	const int8_t SADDLES[2][4] = {
+		{0,1,2,3},	// Case 5, center above: cut off corners 1 and 3.
+		{3,0,1,2}	// Case 10, center above: cut off corners 0 and 2.
+	};
+
+	// Links pieces sharing end edges to chains. Closed loops end with their first edge.
+	void link(const std::vector<Chain>& pieces, std::vector<Chain>& result) {
+		// End edge -> up to two piece ends, encoded as 2*piece + (0 = front, 1 = back).
+		std::unordered_map<uint64_t, std::array<int64_t,2>> ends;
+		ends.reserve(2*pieces.size());
+		auto addEnd = [&](uint64_t edge, int64_t end) {
+			auto it = ends.find(edge);
+			if(it == ends.end()) {
+				ends.emplace(edge, std::array<int64_t,2>{end, -1});
+			} else {
+				it->second[1] = end;
+			}
+		};
+		for(std::size_t i=0; i<pieces.size(); ++i) {
+			addEnd(pieces[i].front(), int64_t(2*i));
+			addEnd(pieces[i].back(), int64_t(2*i+1));
+		}
+		std::vector<bool> used(pieces.size(), false);
+		// Returns piece end connected to given piece end, or -1.
+		auto partner = [&](int64_t end) -> int64_t {
+			const Chain& piece = pieces[end/2];
+			const auto& candidates = ends[(end % 2) ? piece.back() : piece.front()];
+			const int64_t other = candidates[0] == end ? candidates[1] : candidates[0];
+			return (other >= 0 && !used[other/2]) ? other : -1;
+		};
+		for(std::size_t i=0; i<pieces.size(); ++i) {
+			if(used[i]) {
+				continue;
+			}
+			used[i] = true;
+			Chain chain = pieces[i];
+			// Extend forward from back end, then backward from front end.
+			for(int direction=0; direction<2; ++direction) {
+				int64_t end = direction == 0 ? int64_t(2*i+1) : int64_t(2*i);
+				if(direction == 1) {
+					std::reverse(chain.begin(), chain.end());
+				}
+				for(int64_t next = partner(end); next >= 0; ) {
+					const Chain& piece = pieces[next/2];
+					used[next/2] = true;
+					// Shared edge is already in the chain.
+					if(next % 2) {
+						chain.insert(chain.end(), piece.rbegin()+1, piece.rend());
+					} else {
+						chain.insert(chain.end(), piece.begin()+1, piece.end());
+					}
+					// Continue from the other end of the piece.
+					end = next ^ 1;
+					next = partner(end);
+				}
+				// Closed loop: chain already ends with its first edge.
+				if(chain.size() > 2 && chain.front() == chain.back()) {
+					break;
+				}
+			}
+			result.push_back(std::move(chain));
+		}
+	}
+
+	uint64_t checksum(const HeatMap& field, const std::vector<float>& levels) {
+		std::vector<uint64_t> rows(field.size());
+		JobSystem::get().parallelFor("Contours::checksum", 0, field.size(), 64, [&](std::size_t begin, std::size_t end) {
+			for(std::size_t y=begin; y<end; ++y) {
+				uint64_t hash = 1469598103934665603ull;
+				for(float value : field[y]) {
+					uint32_t bits;
+					memcpy(&bits, &value, sizeof(bits));
+					hash = (hash ^ bits) * 1099511628211ull;
+				}
+				rows[y] = hash;
+			}
+		});
+		uint64_t hash = 1469598103934665603ull;
+		for(uint64_t row : rows) {
+			hash = (hash ^ row) * 1099511628211ull;
+		}
+		for(float level : levels) {
+			uint32_t bits;
+			memcpy(&bits, &level, sizeof(bits));
+			hash = (hash ^ bits) * 1099511628211ull;
+		}
+		return hash;
+	}
+}
+
+Contours::Contours(const std::vector<float>& levels, std::size_t tileSize)
+	: m_levels(levels)
+	, m_tileSize(std::max<std::size_t>(tileSize, 2))
+	, m_width(0)
+	, m_height(0)
+	, m_checksum(0)
+	, m_valid(false)
+	, m_version(0)
+	, m_uploadedVersion(0)
+	, m_vao(0)
+	, m_vertexBuffer(0) {
+}
+
+Contours::~Contours() {
+	if(m_vao != 0) {
+		glDeleteVertexArrays(1, &m_vao);
+		glDeleteBuffers(1, &m_vertexBuffer);
+	}
+}
+
+void Contours::setLevels(const std::vector<float>& levels) {
+	m_levels = levels;
+	m_valid = false;
+}
+
+bool Contours::update(const HeatMap& field, bool hashField) {
+	const std::size_t height = field.size();
+	const std::size_t width = height > 0 ? field[0].size() : 0;
+	const bool sameSize = m_valid && width == m_width && height == m_height;
+	if(sameSize && !hashField) {
+		return false;
+	}
+	const uint64_t sum = checksum(field, m_levels);
+	if(sameSize && sum == m_checksum) {
+		return false;
+	}
+	m_width = width;
+	m_height = height;
+	m_checksum = sum;
+	m_valid = true;
+	++m_version;
+	const std::size_t numLevels = m_levels.size();
+	m_polylines.assign(numLevels, {});
+	m_segments.assign(numLevels, {});
+	if(width < 2 || height < 2) {
+		return true;
+	}
+
+	// Contour and link tiles in parallel: chains[tile][level].
+	const std::size_t cellsX = width - 1;
+	const std::size_t cellsY = height - 1;
+	const std::size_t tilesX = (cellsX + m_tileSize - 1) / m_tileSize;
+	const std::size_t tilesY = (cellsY + m_tileSize - 1) / m_tileSize;
+	std::vector< std::vector< std::vector<Chain> > > chains(tilesX*tilesY, std::vector< std::vector<Chain> >(numLevels));
+	JobSystem::get().run("Contours::update", tilesX*tilesY, [&](std::size_t tile) {
+		const std::size_t x0 = (tile % tilesX) * m_tileSize;
+		const std::size_t y0 = (tile / tilesX) * m_tileSize;
+		const std::size_t x1 = std::min(cellsX, x0 + m_tileSize);
+		const std::size_t y1 = std::min(cellsY, y0 + m_tileSize);
+		for(std::size_t level=0; level<numLevels; ++level) {
+			const float iso = m_levels[level];
+			std::vector<Chain> segments;
+			for(std::size_t y=y0; y<y1; ++y) {
+				const float* row0 = field[y].data();
+				const float* row1 = field[y+1].data();
+				for(std::size_t x=x0; x<x1; ++x) {
+					const int index = (row0[x] >= iso ? 1 : 0) | (row0[x+1] >= iso ? 2 : 0) | (row1[x+1] >= iso ? 4 : 0) | (row1[x] >= iso ? 8 : 0);
+					if(index == 0 || index == 15) {
+						continue;
+					}
+					const int8_t* edges = CASES[index];
+					if(index == 5 || index == 10) {
+						const float center = 0.25f * (row0[x] + row0[x+1] + row1[x+1] + row1[x]);
+						if(center >= iso) {
+							edges = SADDLES[index == 5 ? 0 : 1];
+						}
+					}
+					const uint64_t ids[4] = {
+						horizontalEdge(x, y, width), verticalEdge(x+1, y, width),
+						horizontalEdge(x, y+1, width), verticalEdge(x, y, width)
+					};
+					for(int i=0; i<4 && edges[i] >= 0; i += 2) {
+						segments.push_back({ids[edges[i]], ids[edges[i+1]]});
+					}
+				}
+			}
+			link(segments, chains[tile][level]);
+		}
+	});
+
+	// Stitch tile chains across tile boundaries and convert edge ids to points, per level in parallel.
+	JobSystem::get().run("Contours::update", numLevels, [&](std::size_t level) {
+		const float iso = m_levels[level];
+		std::vector<Chain> pieces;
+		for(auto& tile : chains) {
+			for(auto& chain : tile[level]) {
+				pieces.push_back(std::move(chain));
+			}
+		}
+		std::vector<Chain> stitched;
+		link(pieces, stitched);
+
+		auto toPoint = [&](uint64_t edge) {
+			const std::size_t cell = std::size_t(edge / 2);
+			const std::size_t x = cell % width;
+			const std::size_t y = cell / width;
+			const bool vertical = (edge % 2) != 0;
+			const float v0 = field[y][x];
+			const float v1 = vertical ? field[y+1][x] : field[y][x+1];
+			const float t = (iso - v0) / (v1 - v0);
+			return vertical ? vec2(float(x), float(y) + t) : vec2(float(x) + t, float(y));
+		};
+		auto& polylines = m_polylines[level];
+		auto& segments = m_segments[level];
+		for(const auto& chain : stitched) {
+			std::vector<vec2> polyline(chain.size());
+			for(std::size_t i=0; i<chain.size(); ++i) {
+				polyline[i] = toPoint(chain[i]);
+			}
+			for(std::size_t i=0; i+1<polyline.size(); ++i) {
+				segments.push_back(polyline[i]);
+				segments.push_back(polyline[i+1]);
+			}
+			polylines.push_back(std::move(polyline));
+		}
+	});
+	return true;
+}
+
+}
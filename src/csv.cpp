@@ -0,0 +1,214 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/csv.h>
+#include <mikroplot/mapped.h>
+#include <mikroplot/jobs.h>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIKROPLOT_SSE2 1
+#endif
+
+namespace mikroplot {
+
+namespace {
+	const float NOT_A_NUMBER = std::numeric_limits<float>::quiet_NaN();
+
+	// Returns pointer to the first delimiter or newline in [p,end), or end.
+	const char* findSeparator(const char* p, const char* end, char delimiter) {
+#if defined(MIKROPLOT_SSE2)
+		const __m128i delimiters = _mm_set1_epi8(delimiter);
+		const __m128i newlines = _mm_set1_epi8('\n');
+		for(; p+16 <= end; p += 16) {
+			__m128i chars = _mm_loadu_si128((const __m128i*)p);
+			int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chars, delimiters), _mm_cmpeq_epi8(chars, newlines)));
+			if(mask != 0) {
+				int offset = 0;
+				while((mask & 1) == 0) {
+					mask >>= 1;
+					++offset;
+				}
+				return p + offset;
+			}
+		}
+#endif
+		for(; p<end; ++p) {
+			if(*p == delimiter || *p == '\n') {
+				return p;
+			}
+		}
+		return end;
+	}
+
+	// Returns pointer to the beginning of the next line in [p,end), or end.
+	const char* nextLine(const char* p, const char* end) {
+		auto newline = (const char*)memchr(p, '\n', std::size_t(end-p));
+		return newline ? newline+1 : end;
+	}
+
+	float parseValue(const char* begin, const char* end) {
+		while(begin < end && (*begin == ' ' || *begin == '\t' || *begin == '"')) {
+			++begin;
+		}
+		// from_chars does not accept leading '+'.
+		if(begin < end && *begin == '+') {
+			++begin;
+		}
+		float value;
+		auto result = std::from_chars(begin, end, value);
+		return result.ec == std::errc() ? value : NOT_A_NUMBER;
+	}
+
+	std::string trimName(const char* begin, const char* end) {
+		while(begin < end && (*begin == ' ' || *begin == '\t' || *begin == '"')) ++begin;
+		while(end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '"' || end[-1] == '\r')) --end;
+		return std::string(begin, end);
+	}
+}
+
+CsvTable CsvTable::load(const std::string& fileName, const CsvOptions& options) {
+	MappedFile file(fileName);
+	file.advise(AccessPattern::SEQUENTIAL);
+	return parse((const char*)file.getData(), file.getSize(), options);
+}
+
+CsvTable CsvTable::parse(const char* text, std::size_t size, const CsvOptions& options) {
+	CsvTable table;
+	const char* p = text;
+	const char* end = text + size;
+
+	// Header, or number of columns from the first line.
+	std::vector<std::string> allNames;
+	{
+		const char* lineEnd = nextLine(p, end);
+		const char* field = p;
+		while(field < lineEnd) {
+			const char* sep = findSeparator(field, lineEnd, options.delimiter);
+			allNames.push_back(options.hasHeader ? trimName(field, sep) : std::to_string(allNames.size()));
+			field = sep + 1;
+			if(sep == lineEnd || *sep == '\n') {
+				break;
+			}
+		}
+		if(options.hasHeader) {
+			p = lineEnd;
+		}
+	}
+
+	// Map of file column index -> table column index, -1 for skipped.
+	std::vector<int> target(allNames.size(), -1);
+	if(options.columns.empty()) {
+		for(std::size_t i=0; i<allNames.size(); ++i) {
+			target[i] = int(i);
+		}
+		table.m_names = allNames;
+	} else {
+		for(const auto& name : options.columns) {
+			auto it = std::find(allNames.begin(), allNames.end(), name);
+			if(it == allNames.end()) {
+				throw std::runtime_error("CSV column \"" + name + "\" not found!");
+			}
+			target[it - allNames.begin()] = int(table.m_names.size());
+			table.m_names.push_back(name);
+		}
+	}
+	const std::size_t numColumns = table.m_names.size();
+	table.m_columns.resize(numColumns);
+
+	// Split to chunks at line boundaries.
+	std::vector<const char*> bounds = {p};
+	while(bounds.back() < end) {
+		const char* b = bounds.back() + std::min<std::size_t>(std::max<std::size_t>(options.chunkSize, 1), std::size_t(end - bounds.back()));
+		bounds.push_back(b < end ? nextLine(b, end) : end);
+	}
+	const std::size_t numChunks = bounds.size() - 1;
+
+	// Parse chunks to chunk local columns.
+	std::vector< std::vector< std::vector<float> > > chunks(numChunks, std::vector< std::vector<float> >(numColumns));
+	JobSystem::get().run("CsvTable::parse", numChunks, [&](std::size_t chunk) {
+		auto& columns = chunks[chunk];
+		const char* line = bounds[chunk];
+		const char* chunkEnd = bounds[chunk+1];
+		while(line < chunkEnd) {
+			const char* field = line;
+			// Skip empty lines.
+			if(*field == '\n' || *field == '\r') {
+				line = nextLine(line, chunkEnd);
+				continue;
+			}
+			// Field after a trailing delimiter at the end of input is an empty field, as before a newline.
+			std::size_t column = 0;
+			for(;; ++column) {
+				const char* sep = findSeparator(field, chunkEnd, options.delimiter);
+				if(column < target.size() && target[column] >= 0) {
+					columns[target[column]].push_back(parseValue(field, sep));
+				}
+				field = sep + 1;
+				if(sep == chunkEnd || *sep == '\n') {
+					break;
+				}
+			}
+			// Missing fields
+			for(++column; column < target.size(); ++column) {
+				if(target[column] >= 0) {
+					columns[target[column]].push_back(NOT_A_NUMBER);
+				}
+			}
+			line = std::min(field, chunkEnd);
+		}
+	});
+
+	// Concatenate chunks to contiguous columns.
+	std::vector<std::size_t> offsets(numChunks+1, 0);
+	for(std::size_t chunk=0; chunk<numChunks; ++chunk) {
+		offsets[chunk+1] = offsets[chunk] + (numColumns > 0 ? chunks[chunk][0].size() : 0);
+	}
+	for(auto& column : table.m_columns) {
+		column.resize(offsets.back());
+	}
+	JobSystem::get().run("CsvTable::parse", numChunks*numColumns, [&](std::size_t task) {
+		std::size_t chunk = task / std::max<std::size_t>(numColumns, 1);
+		std::size_t column = task % std::max<std::size_t>(numColumns, 1);
+		const auto& values = chunks[chunk][column];
+		std::copy(values.begin(), values.end(), table.m_columns[column].begin() + offsets[chunk]);
+	});
+	return table;
+}
+
+const std::vector<float>& CsvTable::column(const std::string& name) const {
+	auto it = std::find(m_names.begin(), m_names.end(), name);
+	if(it == m_names.end()) {
+		throw std::runtime_error("CSV column \"" + name + "\" not found!");
+	}
+	return m_columns[it - m_names.begin()];
+}
+
+}
@@ -0,0 +1,263 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/decimate.h>
+#include <mikroplot/jobs.h>
+#include <algorithm>
+#include <cmath>
+
+namespace mikroplot {
+namespace decimate {
+
+namespace {
+	// Number of columns processed by a single job.
+	const std::size_t COLUMN_GRAIN = 64;
+
+	// Point accessors used by the algorithms.
+	struct PointArray {
+		const vec2* points;
+		std::size_t count;
+		std::size_t size() const { return count; }
+		float x(std::size_t i) const { return points[i].x; }
+		float y(std::size_t i) const { return points[i].y; }
+	};
+
+	template<typename X, typename Y>
+	struct Columns {
+		X xs;
+		Y ys;
+		std::size_t size() const { return std::min(xs.size(), ys.size()); }
+		float x(std::size_t i) const { return float(xs[i]); }
+		float y(std::size_t i) const { return float(ys[i]); }
+	};
+
+	// Calls f with accessor of typed columns.
+	template<typename F>
+	std::vector<vec2> withColumns(const ColumnView& x, const ColumnView& y, F f) {
+		std::vector<vec2> result;
+		x.visit([&](auto xs) {
+			y.visit([&](auto ys) {
+				result = f(Columns<decltype(xs), decltype(ys)>{xs, ys});
+			});
+		});
+		return result;
+	}
+
+	// Points [begin, begin+count) of other accessor.
+	template<typename Points>
+	struct SubRange {
+		const Points& points;
+		std::size_t begin;
+		std::size_t count;
+		std::size_t size() const { return count; }
+		float x(std::size_t i) const { return points.x(begin + i); }
+		float y(std::size_t i) const { return points.y(begin + i); }
+	};
+
+	// Index of first point, which has x >= value in [begin,end).
+	template<typename Points>
+	std::size_t lowerBound(const Points& points, std::size_t begin, std::size_t end, float value) {
+		std::size_t count = end - begin;
+		while(count > 0) {
+			std::size_t step = count / 2;
+			if(points.x(begin + step) < value) {
+				begin += step + 1;
+				count -= step + 1;
+			} else {
+				count = step;
+			}
+		}
+		return begin;
+	}
+
+	// Appends first, min, max and last of [begin,end) in index order.
+	template<typename Points>
+	void appendColumn(std::vector<vec2>& out, const Points& points, std::size_t begin, std::size_t end) {
+		std::size_t minIndex = begin;
+		std::size_t maxIndex = begin;
+		float minY = points.y(begin);
+		float maxY = minY;
+		for(std::size_t i=begin+1; i<end; ++i) {
+			float y = points.y(i);
+			if(y < minY) { minY = y; minIndex = i; }
+			if(y > maxY) { maxY = y; maxIndex = i; }
+		}
+		std::size_t indices[4] = {begin, std::min(minIndex, maxIndex), std::max(minIndex, maxIndex), end-1};
+		std::size_t prev = ~std::size_t(0);
+		for(auto index : indices) {
+			if(index != prev) {
+				out.push_back(vec2(points.x(index), points.y(index)));
+				prev = index;
+			}
+		}
+	}
+
+	template<typename Points>
+	std::vector<vec2> m4(const Points& points, float left, float right, std::size_t columns) {
+		std::vector<vec2> result;
+		const std::size_t count = points.size();
+		if(count == 0 || columns == 0 || !(left < right)) {
+			return result;
+		}
+		const float columnWidth = (right - left) / float(columns);
+		const std::size_t first = lowerBound(points, 0, count, left);
+		const std::size_t last = lowerBound(points, first, count, right);
+		// Columns are processed in chunks, each chunk to its own output.
+		const std::size_t numChunks = (columns + COLUMN_GRAIN - 1) / COLUMN_GRAIN;
+		std::vector< std::vector<vec2> > chunks(numChunks);
+		JobSystem::get().run("decimate::m4", numChunks, [&](std::size_t chunk) {
+			std::size_t c0 = chunk*COLUMN_GRAIN;
+			std::size_t c1 = std::min(columns, c0 + COLUMN_GRAIN);
+			auto& out = chunks[chunk];
+			out.reserve(4*(c1-c0));
+			std::size_t begin = c0 == 0 ? first : lowerBound(points, first, last, left + float(c0)*columnWidth);
+			for(std::size_t c=c0; c<c1 && begin<last; ++c) {
+				std::size_t end = c+1 == columns ? last : lowerBound(points, begin, last, left + float(c+1)*columnWidth);
+				if(begin < end) {
+					appendColumn(out, points, begin, end);
+				}
+				begin = end;
+			}
+		});
+
+		std::size_t total = 2;
+		for(auto& chunk : chunks) {
+			total += chunk.size();
+		}
+		result.reserve(total);
+		// Keep closest points outside of the view, so that lines continue to the edges.
+		if(first > 0) {
+			result.push_back(vec2(points.x(first-1), points.y(first-1)));
+		}
+		for(auto& chunk : chunks) {
+			result.insert(result.end(), chunk.begin(), chunk.end());
+		}
+		if(last < count) {
+			result.push_back(vec2(points.x(last), points.y(last)));
+		}
+		return result;
+	}
+
+	template<typename Points>
+	std::vector<vec2> lttb(const Points& points, std::size_t threshold) {
+		const std::size_t count = points.size();
+		std::vector<vec2> result;
+		if(threshold >= count || threshold < 3) {
+			result.reserve(count);
+			for(std::size_t i=0; i<count; ++i) {
+				result.push_back(vec2(points.x(i), points.y(i)));
+			}
+			return result;
+		}
+		// Bucket i (1...threshold-2) covers [bucketStart(i), bucketStart(i+1)).
+		const double bucketSize = double(count - 2) / double(threshold - 2);
+		auto bucketStart = [&](std::size_t bucket) {
+			return std::min(count-1, std::size_t(double(bucket-1) * bucketSize) + 1);
+		};
+		// Bucket averages are independent and computed in parallel.
+		std::vector<vec2> averages(threshold);
+		averages[threshold-1] = vec2(points.x(count-1), points.y(count-1));
+		JobSystem::get().parallelFor("decimate::lttb", 1, threshold-1, 64, [&](std::size_t begin, std::size_t end) {
+			for(std::size_t bucket=begin; bucket<end; ++bucket) {
+				std::size_t a = bucketStart(bucket);
+				std::size_t b = std::max(a+1, bucketStart(bucket+1));
+				double sx = 0.0;
+				double sy = 0.0;
+				for(std::size_t i=a; i<b; ++i) {
+					sx += points.x(i);
+					sy += points.y(i);
+				}
+				averages[bucket] = vec2(float(sx / double(b-a)), float(sy / double(b-a)));
+			}
+		});
+
+		result.reserve(threshold);
+		vec2 prev(points.x(0), points.y(0));
+		result.push_back(prev);
+		for(std::size_t bucket=1; bucket<threshold-1; ++bucket) {
+			const vec2& next = averages[bucket+1];
+			std::size_t a = bucketStart(bucket);
+			std::size_t b = std::max(a+1, bucketStart(bucket+1));
+			float maxArea = -1.0f;
+			std::size_t selected = a;
+			for(std::size_t i=a; i<b; ++i) {
+				float area = std::abs((prev.x - next.x) * (points.y(i) - prev.y) - (prev.x - points.x(i)) * (next.y - prev.y));
+				if(area > maxArea) {
+					maxArea = area;
+					selected = i;
+				}
+			}
+			prev = vec2(points.x(selected), points.y(selected));
+			result.push_back(prev);
+		}
+		result.push_back(vec2(points.x(count-1), points.y(count-1)));
+		return result;
+	}
+
+	template<typename Points>
+	std::vector<vec2> lttb(const Points& points, float left, float right, std::size_t threshold) {
+		const std::size_t count = points.size();
+		// Buckets cover only the view and the closest point outside of it on both sides.
+		std::size_t first = lowerBound(points, 0, count, left);
+		std::size_t last = lowerBound(points, first, count, right);
+		first = first > 0 ? first - 1 : first;
+		last = std::min(count, last + 1);
+		return lttb(SubRange<Points>{points, first, last - first}, threshold);
+	}
+}
+
+std::vector<vec2> m4(const vec2* points, std::size_t count, float left, float right, std::size_t columns) {
+	return m4(PointArray{points, count}, left, right, columns);
+}
+
+std::vector<vec2> m4(const ColumnView& x, const ColumnView& y, float left, float right, std::size_t columns) {
+	return withColumns(x, y, [&](const auto& points) {
+		return m4(points, left, right, columns);
+	});
+}
+
+std::vector<vec2> lttb(const vec2* points, std::size_t count, std::size_t threshold) {
+	return lttb(PointArray{points, count}, threshold);
+}
+
+std::vector<vec2> lttb(const ColumnView& x, const ColumnView& y, std::size_t threshold) {
+	return withColumns(x, y, [&](const auto& points) {
+		return lttb(points, threshold);
+	});
+}
+
+std::vector<vec2> lttb(const vec2* points, std::size_t count, float left, float right, std::size_t threshold) {
+	return lttb(PointArray{points, count}, left, right, threshold);
+}
+
+std::vector<vec2> lttb(const ColumnView& x, const ColumnView& y, float left, float right, std::size_t threshold) {
+	return withColumns(x, y, [&](const auto& points) {
+		return lttb(points, left, right, threshold);
+	});
+}
+
+}
+}
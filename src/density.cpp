@@ -0,0 +1,95 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/density.h>
+#include <mikroplot/window.h>
+#include <mikroplot/jobs.h>
+#include <algorithm>
+#include <vector>
+
+namespace mikroplot {
+
+namespace density {
+
+namespace {
+	// Number of points per job.
+	const std::size_t POINT_GRAIN = 65536;
+
+	template<typename Point>
+	void binPoints(std::size_t count, Point point, float left, float right, float bottom, float top, int width, int height, float* counts) {
+		if(count == 0 || width <= 0 || height <= 0 || !(right > left) || !(top > bottom)) {
+			return;
+		}
+		auto& jobs = JobSystem::get();
+		const std::size_t numPixels = std::size_t(width) * std::size_t(height);
+		// Each chunk counts to its own grid. Grids cost memory and a merge pass, so there are only as many as
+		// there are threads and at least a few points per pixel for each.
+		const std::size_t numChunks = std::max<std::size_t>(1, std::min({jobs.getNumThreads(), count / POINT_GRAIN, count / (4*numPixels)}));
+		std::vector< std::vector<uint32_t> > partials(numChunks, std::vector<uint32_t>(numPixels, 0));
+		const float scaleX = float(width) / (right - left);
+		const float scaleY = float(height) / (top - bottom);
+		jobs.run("density::bin", numChunks, [&](std::size_t chunk) {
+			auto& grid = partials[chunk];
+			const std::size_t begin = (count * chunk) / numChunks;
+			const std::size_t end = (count * (chunk+1)) / numChunks;
+			for(std::size_t i=begin; i<end; ++i) {
+				const vec2 p = point(i);
+				const float x = (p.x - left) * scaleX;
+				const float y = (top - p.y) * scaleY;
+				// Also false for NaN.
+				if(x >= 0.0f && x < float(width) && y >= 0.0f && y < float(height)) {
+					++grid[std::size_t(y) * std::size_t(width) + std::size_t(x)];
+				}
+			}
+		});
+		jobs.parallelFor("density::merge", 0, numPixels, 65536, [&](std::size_t begin, std::size_t end) {
+			for(std::size_t i=begin; i<end; ++i) {
+				uint32_t sum = 0;
+				for(auto& grid : partials) {
+					sum += grid[i];
+				}
+				counts[i] += float(sum);
+			}
+		});
+	}
+}
+
+void bin(const vec2* points, std::size_t count, float left, float right, float bottom, float top, int width, int height, float* counts) {
+	binPoints(count, [&](std::size_t i) { return points[i]; }, left, right, bottom, top, width, height, counts);
+}
+
+void bin(const ColumnView& x, const ColumnView& y, float left, float right, float bottom, float top, int width, int height, float* counts) {
+	const std::size_t count = std::min(x.size(), y.size());
+	x.visit([&](auto xs) {
+		y.visit([&](auto ys) {
+			binPoints(count, [&](std::size_t i) { return vec2(float(xs[i]), float(ys[i])); }, left, right, bottom, top, width, height, counts);
+		});
+	});
+}
+
+}
+
+}
@@ -0,0 +1,159 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/dirtygrid.h>
+#include <mikroplot/texture.h>
+#include <algorithm>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIKROPLOT_SSE2 1
+#endif
+
+namespace mikroplot {
+
+namespace {
+	// Returns index of first differing element or n, if rows are equal.
+	std::size_t firstDifference(const int* a, const int* b, std::size_t n) {
+		std::size_t i = 0;
+#if defined(MIKROPLOT_SSE2)
+		for(; i+4 <= n; i += 4) {
+			__m128i va = _mm_loadu_si128((const __m128i*)(a+i));
+			__m128i vb = _mm_loadu_si128((const __m128i*)(b+i));
+			if(_mm_movemask_epi8(_mm_cmpeq_epi32(va, vb)) != 0xFFFF) {
+				break;
+			}
+		}
+#endif
+		for(; i<n; ++i) {
+			if(a[i] != b[i]) return i;
+		}
+		return n;
+	}
+
+	// Returns one past the index of last differing element, or 0 if rows are equal.
+	std::size_t lastDifference(const int* a, const int* b, std::size_t n) {
+		std::size_t i = n;
+#if defined(MIKROPLOT_SSE2)
+		for(; i >= 4; i -= 4) {
+			__m128i va = _mm_loadu_si128((const __m128i*)(a+i-4));
+			__m128i vb = _mm_loadu_si128((const __m128i*)(b+i-4));
+			if(_mm_movemask_epi8(_mm_cmpeq_epi32(va, vb)) != 0xFFFF) {
+				break;
+			}
+		}
+#endif
+		for(; i>0; --i) {
+			if(a[i-1] != b[i-1]) return i;
+		}
+		return 0;
+	}
+}
+
+DirtyGrid::DirtyGrid(std::size_t width, std::size_t height, int value)
+	: m_width(width)
+	, m_height(height)
+	, m_cells(width*height, value)
+	, m_rowSpans(height)
+	, m_dirtyRowBegin(0)
+	, m_dirtyRowEnd(0)
+	, m_texture()
+	, m_owner(0)
+	, m_paletteVersion(0) {
+	markAllDirty();
+}
+
+DirtyGrid::DirtyGrid(const Grid& grid)
+	: DirtyGrid(grid.size() > 0 ? grid[0].size() : 0, grid.size()) {
+	for(std::size_t y=0; y<m_height; ++y) {
+		assert(grid[y].size() == m_width);
+		std::copy(grid[y].begin(), grid[y].end(), m_cells.begin() + y*m_width);
+	}
+}
+
+DirtyGrid::~DirtyGrid() {
+}
+
+void DirtyGrid::fill(std::size_t x, std::size_t y, std::size_t width, std::size_t height, int value) {
+	assert(x+width <= m_width && y+height <= m_height);
+	for(std::size_t row=y; row<y+height; ++row) {
+		auto begin = m_cells.begin() + row*m_width + x;
+		std::fill(begin, begin+width, value);
+	}
+	markDirty(x, y, width, height);
+}
+
+void DirtyGrid::assign(const Grid& grid) {
+	assert(grid.size() == m_height);
+	for(std::size_t y=0; y<m_height; ++y) {
+		assert(grid[y].size() == m_width);
+		const int* src = grid[y].data();
+		int* dst = &m_cells[y*m_width];
+		auto begin = firstDifference(src, dst, m_width);
+		if(begin == m_width) {
+			continue;
+		}
+		auto end = begin + lastDifference(src+begin, dst+begin, m_width-begin);
+		std::copy(src+begin, src+end, dst+begin);
+		markDirty(begin, y, end-begin, 1);
+	}
+}
+
+void DirtyGrid::markDirty(std::size_t x, std::size_t y, std::size_t width, std::size_t height) {
+	if(width == 0 || height == 0) {
+		return;
+	}
+	assert(x+width <= m_width && y+height <= m_height);
+	for(std::size_t row=y; row<y+height; ++row) {
+		auto& span = m_rowSpans[row];
+		if(span.begin >= span.end) {
+			span.begin = uint32_t(x);
+			span.end = uint32_t(x+width);
+		} else {
+			span.begin = std::min(span.begin, uint32_t(x));
+			span.end = std::max(span.end, uint32_t(x+width));
+		}
+	}
+	if(isDirty()) {
+		m_dirtyRowBegin = std::min(m_dirtyRowBegin, y);
+		m_dirtyRowEnd = std::max(m_dirtyRowEnd, y+height);
+	} else {
+		m_dirtyRowBegin = y;
+		m_dirtyRowEnd = y+height;
+	}
+}
+
+void DirtyGrid::markAllDirty() {
+	markDirty(0, 0, m_width, m_height);
+}
+
+void DirtyGrid::clearDirty() {
+	for(std::size_t y=m_dirtyRowBegin; y<m_dirtyRowEnd; ++y) {
+		m_rowSpans[y] = {0, 0};
+	}
+	m_dirtyRowBegin = m_dirtyRowEnd = 0;
+}
+
+}
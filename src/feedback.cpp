@@ -0,0 +1,124 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/feedback.h>
+#include <mikroplot/framebuffer.h>
+#include <mikroplot/texture.h>
+#include <mikroplot/GLUtils.h>
+#include <glad/gl.h>
+#include <stdexcept>
+#include <cstring>
+
+namespace mikroplot {
+
+namespace {
+	const GLenum FORMATS[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+}
+
+Feedback::Feedback(int width, int height, int channels, bool wrap)
+	: m_width(width)
+	, m_height(height)
+	, m_channels(channels)
+	, m_wrap(wrap)
+	, m_steps(0)
+	, m_dirty(false)
+	, m_current(0)
+	, m_pbo(0)
+	, m_fence(0)
+	, m_readbackStep(0) {
+	// RGB float textures are not required to be renderable.
+	if(width <= 0 || height <= 0 || (channels != 1 && channels != 2 && channels != 4)) {
+		throw std::runtime_error("Feedback must have a positive size and 1, 2 or 4 channels!");
+	}
+}
+
+Feedback::~Feedback() {
+	if(m_fence) {
+		glDeleteSync(GLsync(m_fence));
+	}
+	if(m_pbo) {
+		glDeleteBuffers(1, &m_pbo);
+	}
+}
+
+void Feedback::setState(const std::vector<float>& state) {
+	if(state.size() != std::size_t(m_width)*std::size_t(m_height)*std::size_t(m_channels)) {
+		throw std::runtime_error("Feedback state must have width*height*channels values!");
+	}
+	m_pending = state;
+	m_dirty = true;
+}
+
+bool Feedback::requestReadback() {
+	if(!m_fbos[m_current] || m_fence) {
+		return false;
+	}
+	const std::size_t bytes = std::size_t(m_width)*std::size_t(m_height)*std::size_t(m_channels)*sizeof(float);
+	if(!m_pbo) {
+		glGenBuffers(1, &m_pbo);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+	glBufferData(GL_PIXEL_PACK_BUFFER, bytes, 0, GL_STREAM_READ);
+	m_fbos[m_current]->use([&]() {
+		glReadPixels(0, 0, m_width, m_height, FORMATS[m_channels-1], GL_FLOAT, 0);
+	});
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	checkGLError();
+	m_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_readbackStep = m_steps;
+	return true;
+}
+
+bool Feedback::getState(std::vector<float>& state, uint64_t* step) {
+	if(!m_fence) {
+		return false;
+	}
+	// Zero timeout: only polls the fence.
+	const GLenum status = glClientWaitSync(GLsync(m_fence), GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	if(status == GL_TIMEOUT_EXPIRED) {
+		return false;
+	}
+	glDeleteSync(GLsync(m_fence));
+	m_fence = 0;
+	if(status == GL_WAIT_FAILED) {
+		return false;
+	}
+	state.resize(std::size_t(m_width)*std::size_t(m_height)*std::size_t(m_channels));
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+	const void* data = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+	if(data) {
+		memcpy(state.data(), data, state.size()*sizeof(float));
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	checkGLError();
+	if(step) {
+		*step = m_readbackStep;
+	}
+	return data != 0;
+}
+
+}
@@ -44,7 +44,7 @@ namespace {
 }
 
 
-FrameBuffer::FrameBuffer() {
+FrameBuffer::FrameBuffer() : m_previousFboId(0) {
 	glGenFramebuffers(1, &m_fboId);
 	glGenRenderbuffers(1, &m_rboId);
 }
@@ -58,13 +58,15 @@ FrameBuffer::~FrameBuffer() {
 
 void FrameBuffer::addColorTexture( int index, std::shared_ptr<Texture> tex ) {
 	assert( index >= 0 && index < sizeof(COLOR_ATTACHMENT_LOOKUP)/sizeof(COLOR_ATTACHMENT_LOOKUP[0]) );
+	GLint previous = 0;
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
 	glBindFramebuffer(GL_FRAMEBUFFER, m_fboId);
 	//glBindRenderbuffer(GL_RENDERBUFFER, m_rboId);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, COLOR_ATTACHMENT_LOOKUP[index], GL_TEXTURE_2D, tex->getTextureId(), 0);
 	if( GL_FRAMEBUFFER_COMPLETE != glCheckFramebufferStatus(GL_FRAMEBUFFER) ) {
 		throw std::runtime_error("Texture could not add texture to framebuffer!");
 	}
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, previous);
 	if( m_drawBuffers.size() <= std::size_t(index) ) {
 		m_drawBuffers.resize(index+1);
 	}
@@ -77,15 +79,18 @@ void FrameBuffer::addColorTexture( int index, std::shared_ptr<Texture> tex ) {
 
 
 void FrameBuffer::setDepthTexture(std::shared_ptr<Texture> tex) {
+	GLint previous = 0;
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
 	glBindFramebuffer(GL_FRAMEBUFFER, m_fboId);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, tex->getTextureId(), 0);
 	if (GL_FRAMEBUFFER_COMPLETE != glCheckFramebufferStatus(GL_FRAMEBUFFER)) {
 		throw std::runtime_error("Texture could not add texture to framebuffer!");
 	}
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, previous);
 }
 
 void FrameBuffer::bind() {
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_previousFboId);
 	glBindFramebuffer(GL_FRAMEBUFFER, m_fboId);
 	if( GL_FRAMEBUFFER_COMPLETE != glCheckFramebufferStatus(GL_FRAMEBUFFER) ) {
 		throw std::runtime_error("Texture could not add to framebuffer!");
@@ -95,7 +100,7 @@ void FrameBuffer::bind() {
 
 
 void FrameBuffer::unbind() {
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_previousFboId);
 	glBindRenderbuffer(GL_RENDERBUFFER, 0);
 }
 
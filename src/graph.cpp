@@ -0,0 +1,225 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/graph.h>
+#include <mikroplot/jobs.h>
+#include <mikroplot/GLUtils.h>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+namespace mikroplot {
+
+namespace {
+	const uint32_t LEAF_SIZE = 8;
+	const int MAX_DEPTH = 16;	// 16 bits per axis in Morton codes.
+	const std::size_t NODE_GRAIN = 256;
+
+	// Interleaves bits of 16-bit x and y.
+	uint64_t morton(uint32_t x, uint32_t y) {
+		uint64_t code = 0;
+		for(int bit=0; bit<16; ++bit) {
+			code |= uint64_t((x >> bit) & 1) << (2*bit);
+			code |= uint64_t((y >> bit) & 1) << (2*bit+1);
+		}
+		return code;
+	}
+}
+
+GraphLayout::GraphLayout(std::size_t numNodes, const std::vector< std::pair<uint32_t,uint32_t> >& edges, const LayoutOptions& options)
+	: m_options(options)
+	, m_positions(numNodes)
+	, m_next(numNodes)
+	, m_edges(edges)
+	, m_adjacencyStart(numNodes+1, 0)
+	, m_temperature(options.temperature > 0.0f ? options.temperature : 0.1f * options.springLength * std::sqrt(float(numNodes)))
+	, m_version(1)
+	, m_vao(0)
+	, m_positionBuffer(0)
+	, m_indexBuffer(0)
+	, m_uploadedVersion(0) {
+	// Initial positions on a sunflower spiral: deterministic and evenly spread.
+	const float GOLDEN_ANGLE = 2.39996323f;
+	for(std::size_t i=0; i<numNodes; ++i) {
+		const float r = options.springLength * std::sqrt(float(i));
+		m_positions[i] = vec2(r*std::cos(float(i)*GOLDEN_ANGLE), r*std::sin(float(i)*GOLDEN_ANGLE));
+	}
+	// Adjacency in both directions (CSR), so that forces can be computed per node without atomics.
+	for(const auto& edge : m_edges) {
+		++m_adjacencyStart[edge.first+1];
+		++m_adjacencyStart[edge.second+1];
+	}
+	std::partial_sum(m_adjacencyStart.begin(), m_adjacencyStart.end(), m_adjacencyStart.begin());
+	m_adjacency.resize(m_adjacencyStart.back());
+	std::vector<uint32_t> next(m_adjacencyStart.begin(), m_adjacencyStart.end()-1);
+	for(const auto& edge : m_edges) {
+		m_adjacency[next[edge.first]++] = edge.second;
+		m_adjacency[next[edge.second]++] = edge.first;
+	}
+}
+
+GraphLayout::~GraphLayout() {
+	if(m_vao != 0) {
+		glDeleteVertexArrays(1, &m_vao);
+		glDeleteBuffers(1, &m_positionBuffer);
+		glDeleteBuffers(1, &m_indexBuffer);
+	}
+}
+
+int32_t GraphLayout::buildCell(uint32_t begin, uint32_t end, float x0, float y0, float size, int depth) {
+	const int32_t index = int32_t(m_cells.size());
+	m_cells.push_back(Cell());
+	Cell cell;
+	cell.begin = begin;
+	cell.end = end;
+	cell.size = size;
+	cell.mass = float(end - begin);
+	std::fill(cell.children, cell.children+4, -1);
+	if(end - begin > LEAF_SIZE && depth < MAX_DEPTH) {
+		// Morton order: quadrant of the node is given by the next two bits of the code.
+		const int shift = 2*(15 - depth);
+		const float half = 0.5f*size;
+		uint32_t quadrantBegin = begin;
+		for(uint64_t quadrant=0; quadrant<4; ++quadrant) {
+			uint32_t quadrantEnd = uint32_t(std::partition_point(m_order.begin()+quadrantBegin, m_order.begin()+end, [&](uint32_t node) {
+				return ((m_codes[node] >> shift) & 3) <= quadrant;
+			}) - m_order.begin());
+			if(quadrantEnd > quadrantBegin) {
+				int32_t child = buildCell(quadrantBegin, quadrantEnd, x0 + ((quadrant & 1) ? half : 0.0f), y0 + ((quadrant & 2) ? half : 0.0f), half, depth+1);
+				cell.children[quadrant] = child;
+			}
+			quadrantBegin = quadrantEnd;
+		}
+	}
+	// Center of mass from children, or from nodes of a leaf.
+	vec2 sum(0.0f, 0.0f);
+	if(cell.children[0] < 0 && cell.children[1] < 0 && cell.children[2] < 0 && cell.children[3] < 0) {
+		for(uint32_t i=begin; i<end; ++i) {
+			sum.x += m_positions[m_order[i]].x;
+			sum.y += m_positions[m_order[i]].y;
+		}
+	} else {
+		for(auto child : cell.children) {
+			if(child >= 0) {
+				sum.x += m_cells[child].center.x * m_cells[child].mass;
+				sum.y += m_cells[child].center.y * m_cells[child].mass;
+			}
+		}
+	}
+	cell.center = vec2(sum.x / cell.mass, sum.y / cell.mass);
+	m_cells[index] = cell;
+	return index;
+}
+
+void GraphLayout::buildTree() {
+	const std::size_t n = m_positions.size();
+	vec2 minimum(INFINITY, INFINITY);
+	vec2 maximum(-INFINITY, -INFINITY);
+	for(const auto& p : m_positions) {
+		minimum = vec2(std::min(minimum.x, p.x), std::min(minimum.y, p.y));
+		maximum = vec2(std::max(maximum.x, p.x), std::max(maximum.y, p.y));
+	}
+	const float size = std::max({maximum.x - minimum.x, maximum.y - minimum.y, 1e-6f}) * 1.0001f;
+	m_codes.resize(n);
+	JobSystem::get().parallelFor("GraphLayout::buildTree", 0, n, 4096, [&](std::size_t begin, std::size_t end) {
+		for(std::size_t i=begin; i<end; ++i) {
+			const uint32_t x = uint32_t((m_positions[i].x - minimum.x) / size * 65535.0f);
+			const uint32_t y = uint32_t((m_positions[i].y - minimum.y) / size * 65535.0f);
+			m_codes[i] = morton(x, y);
+		}
+	});
+	m_order.resize(n);
+	std::iota(m_order.begin(), m_order.end(), 0);
+	std::sort(m_order.begin(), m_order.end(), [&](uint32_t a, uint32_t b) { return m_codes[a] < m_codes[b]; });
+	m_cells.clear();
+	if(n > 0) {
+		buildCell(0, uint32_t(n), minimum.x, minimum.y, size, 0);
+	}
+}
+
+void GraphLayout::step(std::size_t iterations) {
+	const float theta2 = m_options.theta * m_options.theta;
+	const float softening = 0.01f * m_options.springLength * m_options.springLength;
+	for(std::size_t iteration=0; iteration<iterations; ++iteration) {
+		buildTree();
+		JobSystem::get().parallelFor("GraphLayout::step", 0, m_positions.size(), NODE_GRAIN, [&](std::size_t begin, std::size_t end) {
+			std::vector<int32_t> stack;
+			for(std::size_t node=begin; node<end; ++node) {
+				const vec2 p = m_positions[node];
+				vec2 force(-m_options.gravity * p.x, -m_options.gravity * p.y);
+				// Repulsion: F = repulsion * mass / distance, from cell centers of mass when they are far enough.
+				auto repel = [&](const vec2& q, float mass) {
+					const float dx = p.x - q.x;
+					const float dy = p.y - q.y;
+					const float d2 = dx*dx + dy*dy + softening;
+					const float f = m_options.repulsion * mass / d2;
+					force.x += f * dx;
+					force.y += f * dy;
+				};
+				stack.assign(1, 0);
+				while(!stack.empty()) {
+					const Cell& cell = m_cells[stack.back()];
+					stack.pop_back();
+					const float dx = p.x - cell.center.x;
+					const float dy = p.y - cell.center.y;
+					const bool leaf = cell.children[0] < 0 && cell.children[1] < 0 && cell.children[2] < 0 && cell.children[3] < 0;
+					if(!leaf && cell.size*cell.size < theta2 * (dx*dx + dy*dy)) {
+						repel(cell.center, cell.mass);
+					} else if(leaf) {
+						for(uint32_t i=cell.begin; i<cell.end; ++i) {
+							if(m_order[i] != node) {
+								repel(m_positions[m_order[i]], 1.0f);
+							}
+						}
+					} else {
+						for(auto child : cell.children) {
+							if(child >= 0) stack.push_back(child);
+						}
+					}
+				}
+				// Attraction: springs along edges.
+				for(uint32_t i=m_adjacencyStart[node]; i<m_adjacencyStart[node+1]; ++i) {
+					const vec2 q = m_positions[m_adjacency[i]];
+					const float dx = q.x - p.x;
+					const float dy = q.y - p.y;
+					const float d = std::sqrt(dx*dx + dy*dy) + 1e-9f;
+					const float f = m_options.springStrength * (d - m_options.springLength) / d;
+					force.x += f * dx;
+					force.y += f * dy;
+				}
+				// Displacement limited by temperature.
+				const float length = std::sqrt(force.x*force.x + force.y*force.y);
+				const float scale = length > m_temperature ? m_temperature / length : 1.0f;
+				m_next[node] = vec2(p.x + force.x*scale, p.y + force.y*scale);
+			}
+		});
+		m_positions.swap(m_next);
+		m_temperature = std::max(m_options.minTemperature, m_temperature * m_options.cooling);
+		++m_version;
+	}
+}
+
+}
@@ -0,0 +1,96 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/histogram.h>
+#include <mikroplot/jobs.h>
+#include <algorithm>
+#include <cassert>
+
+namespace mikroplot {
+
+namespace {
+	// Number of values per job.
+	const std::size_t VALUE_GRAIN = 65536;
+}
+
+Histogram::Histogram(float min, float max, std::size_t numBins)
+	: m_min(min)
+	, m_max(max)
+	, m_counts(std::max<std::size_t>(numBins, 1) + 2, 0)
+	, m_total(0) {
+	assert(min < max);
+}
+
+template<typename View>
+void Histogram::addView(const View& values) {
+	auto& jobs = JobSystem::get();
+	const std::size_t count = values.size();
+	const std::size_t numChunks = std::max<std::size_t>(1, std::min(jobs.getNumThreads(), count / VALUE_GRAIN));
+	const std::size_t numBins = getNumBins();
+	const double scale = double(numBins) / (double(m_max) - double(m_min));
+	std::vector< std::vector<uint64_t> > partials(numChunks, std::vector<uint64_t>(m_counts.size(), 0));
+	std::vector<uint64_t> nans(numChunks, 0);
+	jobs.run("Histogram::add", numChunks, [&](std::size_t chunk) {
+		auto& counts = partials[chunk];
+		const std::size_t begin = (count * chunk) / numChunks;
+		const std::size_t end = (count * (chunk+1)) / numChunks;
+		for(std::size_t i=begin; i<end; ++i) {
+			const double value = double(values[i]);
+			if(value < m_min) {
+				++counts.front();
+			} else if(value > m_max) {
+				++counts.back();
+			} else if(value == value) {
+				++counts[1 + std::min(std::size_t((value - m_min) * scale), numBins-1)];
+			} else {
+				++nans[chunk];
+			}
+		}
+	});
+	for(std::size_t chunk=0; chunk<numChunks; ++chunk) {
+		for(std::size_t bin=0; bin<m_counts.size(); ++bin) {
+			m_counts[bin] += partials[chunk][bin];
+		}
+		m_total += ((count * (chunk+1)) / numChunks - (count * chunk) / numChunks) - nans[chunk];
+	}
+}
+
+void Histogram::add(const float* values, std::size_t count) {
+	addView(StridedView<float>{(const uint8_t*)values, count, sizeof(float)});
+}
+
+void Histogram::add(const ColumnView& values) {
+	values.visit([&](const auto& view) {
+		addView(view);
+	});
+}
+
+void Histogram::clear() {
+	std::fill(m_counts.begin(), m_counts.end(), 0);
+	m_total = 0;
+}
+
+}
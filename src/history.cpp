@@ -0,0 +1,293 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/history.h>
+#include <mikroplot/jobs.h>
+#include <algorithm>
+#include <cstring>
+
+namespace mikroplot {
+
+namespace {
+	int countLeadingZeros(uint32_t x) {
+		int n = 0;
+		for(uint32_t mask = 0x80000000u; mask != 0 && (x & mask) == 0; mask >>= 1) {
+			++n;
+		}
+		return n;
+	}
+
+	int countTrailingZeros(uint32_t x) {
+		int n = 0;
+		for(; n < 32 && (x & 1u) == 0; x >>= 1) {
+			++n;
+		}
+		return n;
+	}
+
+	uint32_t floatBits(float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	float bitsFloat(uint32_t bits) {
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	class BitReader {
+	public:
+		explicit BitReader(const std::vector<uint64_t>& words) : m_words(words), m_position(0) {}
+
+		uint64_t read(int numBits) {
+			uint64_t result = 0;
+			while(numBits > 0) {
+				std::size_t word = m_position / 64;
+				int offset = int(m_position % 64);
+				int n = std::min(numBits, 64 - offset);
+				uint64_t bits = (m_words[word] << offset) >> (64 - n);
+				result = n == 64 ? bits : (result << n) | bits;
+				numBits -= n;
+				m_position += n;
+			}
+			return result;
+		}
+
+		bool readBit() {
+			return read(1) != 0;
+		}
+
+	private:
+		const std::vector<uint64_t>& m_words;
+		std::size_t                  m_position;
+	};
+
+	// Sign extends numBits wide two's complement value.
+	int64_t signExtend(uint64_t value, int numBits) {
+		uint64_t sign = uint64_t(1) << (numBits - 1);
+		return int64_t((value ^ sign) - sign);
+	}
+}
+
+SeriesHistory::SeriesHistory(double timeScale, int64_t timeOrigin, std::size_t blockSize)
+	: m_timeScale(timeScale)
+	, m_timeOrigin(timeOrigin)
+	, m_blockSize(std::max<std::size_t>(blockSize, 2))
+	, m_numSamples(0) {
+}
+
+void SeriesHistory::write(Block& block, uint64_t value, int numBits) {
+	while(numBits > 0) {
+		int offset = int(block.numBits % 64);
+		if(offset == 0) {
+			block.bits.push_back(0);
+		}
+		int n = std::min(numBits, 64 - offset);
+		uint64_t bits = (numBits == 64 && n == 64) ? value : (value >> (numBits - n)) & ((uint64_t(1) << n) - 1);
+		block.bits.back() |= (n == 64) ? bits : bits << (64 - offset - n);
+		numBits -= n;
+		block.numBits += n;
+	}
+}
+
+void SeriesHistory::append(int64_t timestamp, float value) {
+	const uint32_t valueBits = floatBits(value);
+	if(m_blocks.empty() || m_blocks.back().count >= m_blockSize) {
+		// Previous block is complete: free unused capacity.
+		if(!m_blocks.empty()) {
+			m_blocks.back().bits.shrink_to_fit();
+		}
+		m_blocks.push_back(Block());
+		Block& block = m_blocks.back();
+		block.firstTime = timestamp;
+		block.bits.reserve((m_blockSize * 16) / 64);
+		write(block, uint64_t(timestamp), 64);
+		write(block, valueBits, 32);
+		m_encoder = Encoder();
+		m_encoder.prevTime = timestamp;
+		m_encoder.prevValue = valueBits;
+	} else {
+		Block& block = m_blocks.back();
+		// Timestamp: delta-of-delta with variable length prefix.
+		const int64_t delta = timestamp - m_encoder.prevTime;
+		const int64_t dod = delta - m_encoder.prevDelta;
+		if(dod == 0) {
+			write(block, 0, 1);
+		} else if(dod >= -64 && dod <= 63) {
+			write(block, 0x2, 2);
+			write(block, uint64_t(dod) & 0x7f, 7);
+		} else if(dod >= -256 && dod <= 255) {
+			write(block, 0x6, 3);
+			write(block, uint64_t(dod) & 0x1ff, 9);
+		} else if(dod >= -2048 && dod <= 2047) {
+			write(block, 0xe, 4);
+			write(block, uint64_t(dod) & 0xfff, 12);
+		} else {
+			write(block, 0xf, 4);
+			write(block, uint64_t(dod), 64);
+		}
+		m_encoder.prevDelta = delta;
+		m_encoder.prevTime = timestamp;
+
+		// Value: XOR with previous value, meaningful bits only.
+		const uint32_t x = valueBits ^ m_encoder.prevValue;
+		if(x == 0) {
+			write(block, 0, 1);
+		} else {
+			const int leading = std::min(countLeadingZeros(x), 31);
+			const int trailing = countTrailingZeros(x);
+			if(m_encoder.prevLeading >= 0 && leading >= m_encoder.prevLeading && trailing >= m_encoder.prevTrailing) {
+				// Fits in previous window.
+				const int length = 32 - m_encoder.prevLeading - m_encoder.prevTrailing;
+				write(block, 0x2, 2);
+				write(block, x >> m_encoder.prevTrailing, length);
+			} else {
+				const int length = 32 - leading - trailing;
+				write(block, 0x3, 2);
+				write(block, uint64_t(leading), 5);
+				write(block, uint64_t(length - 1), 5);
+				write(block, x >> trailing, length);
+				m_encoder.prevLeading = leading;
+				m_encoder.prevTrailing = trailing;
+			}
+		}
+		m_encoder.prevValue = valueBits;
+	}
+	Block& block = m_blocks.back();
+	block.lastTime = timestamp;
+	++block.count;
+	++m_numSamples;
+}
+
+void SeriesHistory::decode(const Block& block, std::vector<vec2>& out) const {
+	out.resize(block.count);
+	BitReader reader(block.bits);
+	int64_t time = int64_t(reader.read(64));
+	uint32_t value = uint32_t(reader.read(32));
+	int64_t delta = 0;
+	int leading = 0;
+	int trailing = 0;
+	for(std::size_t i=0; i<block.count; ++i) {
+		if(i > 0) {
+			int64_t dod;
+			if(!reader.readBit()) {
+				dod = 0;
+			} else if(!reader.readBit()) {
+				dod = signExtend(reader.read(7), 7);
+			} else if(!reader.readBit()) {
+				dod = signExtend(reader.read(9), 9);
+			} else if(!reader.readBit()) {
+				dod = signExtend(reader.read(12), 12);
+			} else {
+				dod = int64_t(reader.read(64));
+			}
+			delta += dod;
+			time += delta;
+
+			if(reader.readBit()) {
+				if(reader.readBit()) {
+					leading = int(reader.read(5));
+					const int length = int(reader.read(5)) + 1;
+					trailing = 32 - leading - length;
+				}
+				const int length = 32 - leading - trailing;
+				value ^= uint32_t(reader.read(length)) << trailing;
+			}
+		}
+		out[i] = vec2(float(double(time - m_timeOrigin) * m_timeScale), bitsFloat(value));
+	}
+}
+
+std::vector<vec2> SeriesHistory::query(double left, double right) const {
+	std::vector<vec2> result;
+	if(m_blocks.empty()) {
+		return result;
+	}
+	auto toX = [&](int64_t t) { return double(t - m_timeOrigin) * m_timeScale; };
+	// Visible blocks [first,last], including neighbours containing the closest samples outside the range.
+	auto firstIt = std::lower_bound(m_blocks.begin(), m_blocks.end(), left, [&](const Block& b, double x) { return toX(b.lastTime) < x; });
+	auto lastIt = std::upper_bound(m_blocks.begin(), m_blocks.end(), right, [&](double x, const Block& b) { return x < toX(b.firstTime); });
+	std::size_t first = std::size_t(firstIt - m_blocks.begin());
+	std::size_t last = std::size_t(lastIt - m_blocks.begin());
+	first = first > 0 ? first - 1 : 0;
+	last = std::min(last, m_blocks.size() - 1);
+	if(last < first) {
+		return result;
+	}
+
+	// Drop blocks scrolled out of view and decode missing blocks in parallel.
+	const std::size_t lastSealed = m_blocks.size() - 1;
+	for(auto it = m_cache.begin(); it != m_cache.end(); ) {
+		it = (it->first < first || it->first > last) ? m_cache.erase(it) : std::next(it);
+	}
+	std::vector<std::size_t> missing;
+	for(std::size_t i=first; i<=last; ++i) {
+		if(m_cache.find(i) == m_cache.end()) {
+			missing.push_back(i);
+			m_cache[i];
+		}
+	}
+	std::vector<vec2> open;
+	std::vector<std::vector<vec2>*> targets;
+	for(auto i : missing) {
+		targets.push_back(i == lastSealed ? &open : &m_cache[i]);
+	}
+	JobSystem::get().run("SeriesHistory::query", missing.size(), [&](std::size_t task) {
+		decode(m_blocks[missing[task]], *targets[task]);
+	});
+	if(!missing.empty() && missing.back() == lastSealed) {
+		m_cache.erase(lastSealed);
+	}
+
+	// Concatenate and trim to the range plus one sample on both sides.
+	for(std::size_t i=first; i<=last; ++i) {
+		const auto& points = (i == lastSealed) ? open : m_cache[i];
+		auto begin = points.begin();
+		auto end = points.end();
+		if(i == first) {
+			begin = std::lower_bound(begin, end, left, [](const vec2& p, double x) { return p.x < x; });
+			if(begin != points.begin()) --begin;
+		}
+		if(i == last) {
+			end = std::upper_bound(begin, end, right, [](double x, const vec2& p) { return x < p.x; });
+			if(end != points.end()) ++end;
+		}
+		result.insert(result.end(), begin, end);
+	}
+	return result;
+}
+
+std::size_t SeriesHistory::getCompressedSize() const {
+	std::size_t size = 0;
+	for(const auto& block : m_blocks) {
+		size += sizeof(Block) + block.bits.capacity()*sizeof(uint64_t);
+	}
+	return size;
+}
+
+}
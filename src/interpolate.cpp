@@ -0,0 +1,235 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/interpolate.h>
+#include <mikroplot/jobs.h>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+namespace mikroplot {
+
+namespace {
+	// Ranges larger than this are split in parallel.
+	const std::size_t PARALLEL_BUILD_SIZE = 8192;
+
+	inline float axis(const vec2& p, int a) {
+		return a == 0 ? p.x : p.y;
+	}
+}
+
+Interpolator::Interpolator(std::size_t width, std::size_t height, float left, float right, float bottom, float top, const InterpolationOptions& options)
+	: m_options(options)
+	, m_left(left)
+	, m_top(top)
+	, m_cellWidth((right - left) / float(std::max<std::size_t>(width, 1)))
+	, m_cellHeight((top - bottom) / float(std::max<std::size_t>(height, 1)))
+	, m_grid(height, std::vector<float>(width, std::numeric_limits<float>::quiet_NaN()))
+	, m_treeDirty(false) {
+	m_options.neighbors = std::max<std::size_t>(m_options.neighbors, 1);
+	const std::size_t tileSize = std::max<std::size_t>(m_options.tileSize, 1);
+	for(std::size_t y=0; y<height; y += tileSize) {
+		for(std::size_t x=0; x<width; x += tileSize) {
+			m_tiles.push_back(Tile{x, y, std::min(width, x + tileSize), std::min(height, y + tileSize), 0.0f, true});
+		}
+	}
+}
+
+void Interpolator::setSensors(const std::vector<vec2>& positions, const std::vector<float>& values) {
+	assert(positions.size() == values.size());
+	m_positions = positions;
+	m_values = values;
+	m_treeDirty = true;
+	for(auto& tile : m_tiles) {
+		tile.dirty = true;
+	}
+}
+
+void Interpolator::setValue(std::size_t sensor, float value) {
+	assert(sensor < m_values.size());
+	m_values[sensor] = value;
+	markDirty(m_positions[sensor]);
+}
+
+void Interpolator::setPosition(std::size_t sensor, const vec2& position) {
+	assert(sensor < m_positions.size());
+	// Tiles, which used the sensor, and tiles, where it becomes one of the nearest.
+	markDirty(m_positions[sensor]);
+	m_positions[sensor] = position;
+	markDirty(position);
+	m_treeDirty = true;
+}
+
+void Interpolator::markDirty(const vec2& position) {
+	if(position.x != position.x || position.y != position.y) {
+		return;
+	}
+	for(auto& tile : m_tiles) {
+		// Distance to the rectangle of cell centers of the tile.
+		const float minX = m_left + (float(tile.x0) + 0.5f) * m_cellWidth;
+		const float maxX = m_left + (float(tile.x1) - 0.5f) * m_cellWidth;
+		const float maxY = m_top - (float(tile.y0) + 0.5f) * m_cellHeight;
+		const float minY = m_top - (float(tile.y1) - 0.5f) * m_cellHeight;
+		const float dx = std::max({minX - position.x, 0.0f, position.x - maxX});
+		const float dy = std::max({minY - position.y, 0.0f, position.y - maxY});
+		if(dx*dx + dy*dy <= tile.radius2) {
+			tile.dirty = true;
+		}
+	}
+}
+
+void Interpolator::build(std::size_t begin, std::size_t end) {
+	if(end - begin <= 1) {
+		return;
+	}
+	// Split along the longer side of the bounding box.
+	vec2 low(m_positions[m_tree[begin]]);
+	vec2 high(low);
+	for(std::size_t i=begin+1; i<end; ++i) {
+		const vec2& p = m_positions[m_tree[i]];
+		low = vec2(std::min(low.x, p.x), std::min(low.y, p.y));
+		high = vec2(std::max(high.x, p.x), std::max(high.y, p.y));
+	}
+	const int a = (high.x - low.x) >= (high.y - low.y) ? 0 : 1;
+	const std::size_t median = (begin + end) / 2;
+	std::nth_element(m_tree.begin() + begin, m_tree.begin() + median, m_tree.begin() + end, [&](uint32_t i, uint32_t j) {
+		return axis(m_positions[i], a) < axis(m_positions[j], a);
+	});
+	m_splitAxis[median] = uint8_t(a);
+	if(end - begin > PARALLEL_BUILD_SIZE) {
+		JobSystem::get().run("Interpolator::build", 2, [&](std::size_t half) {
+			if(half == 0) {
+				build(begin, median);
+			} else {
+				build(median + 1, end);
+			}
+		});
+	} else {
+		build(begin, median);
+		build(median + 1, end);
+	}
+}
+
+void Interpolator::search(std::size_t begin, std::size_t end, const vec2& position, float maxDistance2, Neighbors& heap) const {
+	if(begin >= end) {
+		return;
+	}
+	const std::size_t median = (begin + end) / 2;
+	const uint32_t index = m_tree[median];
+	const vec2& p = m_treePositions[median];
+	const float dx = position.x - p.x;
+	const float dy = position.y - p.y;
+	const float distance2 = dx*dx + dy*dy;
+	// Heap holds the nearest sensors found so far, farthest on top.
+	auto bound = [&]() { return heap.size() < m_options.neighbors ? maxDistance2 : heap.front().first; };
+	if(distance2 <= bound()) {
+		if(heap.size() == m_options.neighbors) {
+			std::pop_heap(heap.begin(), heap.end());
+			heap.pop_back();
+		}
+		heap.emplace_back(distance2, index);
+		std::push_heap(heap.begin(), heap.end());
+	}
+	const float diff = axis(position, m_splitAxis[median]) - axis(p, m_splitAxis[median]);
+	if(diff < 0.0f) {
+		search(begin, median, position, maxDistance2, heap);
+		if(diff*diff <= bound()) {
+			search(median + 1, end, position, maxDistance2, heap);
+		}
+	} else {
+		search(median + 1, end, position, maxDistance2, heap);
+		if(diff*diff <= bound()) {
+			search(begin, median, position, maxDistance2, heap);
+		}
+	}
+}
+
+void Interpolator::computeTile(Tile& tile) {
+	const float maxDistance2 = m_options.maxDistance * m_options.maxDistance;
+	const float halfPower = 0.5f * m_options.power;
+	Neighbors heap;
+	heap.reserve(m_options.neighbors);
+	float radius2 = 0.0f;
+	for(std::size_t y=tile.y0; y<tile.y1; ++y) {
+		for(std::size_t x=tile.x0; x<tile.x1; ++x) {
+			const vec2 center(m_left + (float(x) + 0.5f) * m_cellWidth, m_top - (float(y) + 0.5f) * m_cellHeight);
+			heap.clear();
+			search(0, m_tree.size(), center, maxDistance2, heap);
+			// Sensors farther than this can not change the cell.
+			radius2 = std::max(radius2, heap.size() < m_options.neighbors ? maxDistance2 : heap.front().first);
+			float value = std::numeric_limits<float>::quiet_NaN();
+			double weightSum = 0.0;
+			double valueSum = 0.0;
+			for(auto& neighbor : heap) {
+				if(neighbor.first == 0.0f) {
+					value = m_values[neighbor.second];
+					weightSum = 0.0;
+					break;
+				}
+				const double weight = 1.0 / std::pow(double(neighbor.first), double(halfPower));
+				weightSum += weight;
+				valueSum += weight * double(m_values[neighbor.second]);
+			}
+			if(weightSum > 0.0) {
+				value = float(valueSum / weightSum);
+			}
+			m_grid[y][x] = value;
+		}
+	}
+	tile.radius2 = radius2;
+	tile.dirty = false;
+}
+
+std::size_t Interpolator::update() {
+	if(m_treeDirty) {
+		m_tree.clear();
+		for(std::size_t i=0; i<m_positions.size(); ++i) {
+			const vec2& p = m_positions[i];
+			if(p.x == p.x && p.y == p.y) {
+				m_tree.push_back(uint32_t(i));
+			}
+		}
+		m_splitAxis.assign(m_tree.size(), 0);
+		build(0, m_tree.size());
+		m_treePositions.resize(m_tree.size());
+		for(std::size_t i=0; i<m_tree.size(); ++i) {
+			m_treePositions[i] = m_positions[m_tree[i]];
+		}
+		m_treeDirty = false;
+	}
+	std::vector<Tile*> dirty;
+	for(auto& tile : m_tiles) {
+		if(tile.dirty) {
+			dirty.push_back(&tile);
+		}
+	}
+	JobSystem::get().run("Interpolator::update", dirty.size(), [&](std::size_t i) {
+		computeTile(*dirty[i]);
+	});
+	return dirty.size();
+}
+
+}
@@ -0,0 +1,254 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/jobs.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <chrono>
+#include <exception>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace mikroplot {
+
+namespace {
+	thread_local int workerIndex = -1;
+
+	void pinThread(std::thread& thread, std::size_t core) {
+#if defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(core % CPU_SETSIZE, &set);
+		pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#elif defined(_WIN32)
+		SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << (core % (8*sizeof(DWORD_PTR))));
+#else
+		(void)thread;
+		(void)core;
+#endif
+	}
+}
+
+struct JobSystem::Impl {
+	struct Job {
+		const std::function<void(std::size_t)>* task;
+		std::atomic<std::size_t>                remaining;
+		std::mutex                              errorMutex;
+		std::exception_ptr                      error;
+	};
+
+	struct Task {
+		Job*        job;
+		std::size_t index;
+	};
+
+	struct Queue {
+		std::mutex       mutex;
+		std::deque<Task> tasks;
+	};
+
+	std::vector< std::unique_ptr<Queue> > queues;
+	std::vector<std::thread>              threads;
+	std::atomic<bool>                     quit{false};
+	std::atomic<std::size_t>              pending{0};
+	std::atomic<std::size_t>              nextQueue{0};
+	std::mutex                            sleepMutex;
+	std::condition_variable               wake;
+	mutable std::mutex                    timingMutex;
+	std::map<std::string, JobTiming>      timings;
+
+	// Pops task from own queue or steals one from other queues.
+	bool tryRunOne(int home) {
+		const std::size_t numQueues = queues.size();
+		for(std::size_t i=0; i<numQueues; ++i) {
+			bool own = home >= 0 && i == 0;
+			auto& queue = *queues[(std::size_t(home < 0 ? 0 : home) + i) % numQueues];
+			Task task;
+			{
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				if(queue.tasks.empty()) {
+					continue;
+				}
+				// Owner works LIFO, thieves FIFO.
+				if(own) {
+					task = queue.tasks.back();
+					queue.tasks.pop_back();
+				} else {
+					task = queue.tasks.front();
+					queue.tasks.pop_front();
+				}
+			}
+			--pending;
+			execute(task);
+			return true;
+		}
+		return false;
+	}
+
+	void execute(const Task& task) {
+		try {
+			(*task.job->task)(task.index);
+		} catch(...) {
+			std::lock_guard<std::mutex> lock(task.job->errorMutex);
+			if(!task.job->error) {
+				task.job->error = std::current_exception();
+			}
+		}
+		task.job->remaining.fetch_sub(1, std::memory_order_release);
+	}
+
+	void workerLoop(int index) {
+		workerIndex = index;
+		while(!quit) {
+			if(tryRunOne(index)) {
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			wake.wait(lock, [&]() { return quit || pending > 0; });
+		}
+	}
+};
+
+namespace {
+	std::unique_ptr<JobSystem> instance;
+	std::mutex instanceMutex;
+}
+
+JobSystem::JobSystem(const JobConfig& config)
+	: m_impl(std::make_unique<Impl>()) {
+	std::size_t numThreads = config.numThreads;
+	if(numThreads == 0) {
+		numThreads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+	}
+	// Calling thread is one of the threads.
+	std::size_t numWorkers = numThreads - 1;
+	for(std::size_t i=0; i<numWorkers; ++i) {
+		m_impl->queues.push_back(std::make_unique<Impl::Queue>());
+	}
+	for(std::size_t i=0; i<numWorkers; ++i) {
+		m_impl->threads.emplace_back([this, i]() {
+			m_impl->workerLoop(int(i));
+		});
+		if(config.pinThreads) {
+			pinThread(m_impl->threads.back(), config.firstCore + i);
+		}
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(m_impl->sleepMutex);
+		m_impl->quit = true;
+	}
+	m_impl->wake.notify_all();
+	for(auto& thread : m_impl->threads) {
+		thread.join();
+	}
+}
+
+JobSystem& JobSystem::get() {
+	std::lock_guard<std::mutex> lock(instanceMutex);
+	if(!instance) {
+		instance = std::make_unique<JobSystem>();
+	}
+	return *instance;
+}
+
+void JobSystem::configure(const JobConfig& config) {
+	std::lock_guard<std::mutex> lock(instanceMutex);
+	instance = 0;
+	instance = std::make_unique<JobSystem>(config);
+}
+
+std::size_t JobSystem::getNumThreads() const {
+	return m_impl->threads.size() + 1;
+}
+
+void JobSystem::run(const char* name, std::size_t numTasks, const std::function<void(std::size_t)>& task) {
+	if(numTasks == 0) {
+		return;
+	}
+	auto start = std::chrono::steady_clock::now();
+	if(numTasks == 1 || m_impl->queues.empty()) {
+		// Not worth of scheduling.
+		for(std::size_t i=0; i<numTasks; ++i) {
+			task(i);
+		}
+	} else {
+		Impl::Job job;
+		job.task = &task;
+		job.remaining = numTasks;
+		const std::size_t numQueues = m_impl->queues.size();
+		std::size_t first = m_impl->nextQueue.fetch_add(1) % numQueues;
+		m_impl->pending += numTasks;
+		for(std::size_t i=0; i<numTasks; ++i) {
+			auto& queue = *m_impl->queues[(first + i) % numQueues];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back({&job, i});
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_impl->sleepMutex);
+		}
+		m_impl->wake.notify_all();
+		// Help until the job is done.
+		while(job.remaining.load(std::memory_order_acquire) > 0) {
+			if(!m_impl->tryRunOne(workerIndex)) {
+				std::this_thread::yield();
+			}
+		}
+		if(job.error) {
+			std::rethrow_exception(job.error);
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::lock_guard<std::mutex> lock(m_impl->timingMutex);
+	auto& timing = m_impl->timings[name];
+	++timing.calls;
+	timing.tasks += numTasks;
+	timing.totalSeconds += seconds;
+	timing.lastSeconds = seconds;
+}
+
+std::map<std::string, JobTiming> JobSystem::getTimings() const {
+	std::lock_guard<std::mutex> lock(m_impl->timingMutex);
+	return m_impl->timings;
+}
+
+void JobSystem::resetTimings() {
+	std::lock_guard<std::mutex> lock(m_impl->timingMutex);
+	m_impl->timings.clear();
+}
+
+}
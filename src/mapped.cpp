@@ -0,0 +1,241 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/mapped.h>
+#include <stdexcept>
+#include <algorithm>
+#include <string.h>
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace mikroplot {
+
+#if defined(_WIN32)
+MappedFile::MappedFile(const std::string& fileName)
+	: m_data(0)
+	, m_size(0)
+	, m_modificationTime(0)
+	, m_file(INVALID_HANDLE_VALUE)
+	, m_mapping(0) {
+	m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if(m_file == INVALID_HANDLE_VALUE) {
+		throw std::runtime_error("Failed to open file \"" + fileName + "\"!");
+	}
+	LARGE_INTEGER size;
+	GetFileSizeEx(m_file, &size);
+	m_size = std::size_t(size.QuadPart);
+	FILETIME written;
+	if(GetFileTime(m_file, 0, 0, &written)) {
+		m_modificationTime = (int64_t(written.dwHighDateTime) << 32) | int64_t(written.dwLowDateTime);
+	}
+	if(m_size > 0) {
+		m_mapping = CreateFileMappingA(m_file, 0, PAGE_READONLY, 0, 0, 0);
+		m_data = m_mapping ? (const uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : 0;
+		if(m_data == 0) {
+			if(m_mapping) CloseHandle(m_mapping);
+			CloseHandle(m_file);
+			throw std::runtime_error("Failed to map file \"" + fileName + "\"!");
+		}
+	}
+}
+
+MappedFile::~MappedFile() {
+	if(m_data) UnmapViewOfFile(m_data);
+	if(m_mapping) CloseHandle(m_mapping);
+	CloseHandle(m_file);
+}
+
+void MappedFile::advise(AccessPattern pattern) const {
+	// Windows has no madvise. PrefetchVirtualMemory could be used for sequential access.
+	(void)pattern;
+}
+#else
+MappedFile::MappedFile(const std::string& fileName)
+	: m_data(0)
+	, m_size(0)
+	, m_modificationTime(0) {
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if(fd < 0) {
+		throw std::runtime_error("Failed to open file \"" + fileName + "\"!");
+	}
+	struct stat st;
+	if(fstat(fd, &st) != 0) {
+		close(fd);
+		throw std::runtime_error("Failed to stat file \"" + fileName + "\"!");
+	}
+	m_size = std::size_t(st.st_size);
+	// Nanoseconds since epoch.
+#if defined(__APPLE__)
+	m_modificationTime = int64_t(st.st_mtimespec.tv_sec)*1000000000 + int64_t(st.st_mtimespec.tv_nsec);
+#else
+	m_modificationTime = int64_t(st.st_mtim.tv_sec)*1000000000 + int64_t(st.st_mtim.tv_nsec);
+#endif
+	if(m_size > 0) {
+		void* data = mmap(0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(data == MAP_FAILED) {
+			close(fd);
+			throw std::runtime_error("Failed to map file \"" + fileName + "\"!");
+		}
+		m_data = (const uint8_t*)data;
+	}
+	// Mapping keeps the file open.
+	close(fd);
+}
+
+MappedFile::~MappedFile() {
+	if(m_data) {
+		munmap((void*)m_data, m_size);
+	}
+}
+
+void MappedFile::advise(AccessPattern pattern) const {
+	if(m_data == 0) {
+		return;
+	}
+	int advice = MADV_NORMAL;
+	if(pattern == AccessPattern::SEQUENTIAL) {
+		advice = MADV_SEQUENTIAL;
+	} else if(pattern == AccessPattern::RANDOM) {
+		advice = MADV_RANDOM;
+	}
+	madvise((void*)m_data, m_size, advice);
+}
+#endif
+
+ArrayFile::ArrayFile(std::unique_ptr<MappedFile> file, std::size_t offset, DataType type, std::size_t numRows, std::size_t numColumns, bool columnMajor)
+	: m_file(std::move(file))
+	, m_offset(offset)
+	, m_type(type)
+	, m_numRows(numRows)
+	, m_numColumns(numColumns)
+	, m_columnMajor(columnMajor) {
+}
+
+ColumnView ArrayFile::column(std::size_t index) const {
+	assert(index < m_numColumns);
+	const std::size_t valueSize = m_type == DataType::FLOAT32 ? sizeof(float) : sizeof(double);
+	const uint8_t* base = m_file->getData() + m_offset;
+	if(m_columnMajor) {
+		return ColumnView(base + index*m_numRows*valueSize, m_numRows, valueSize, m_type);
+	}
+	return ColumnView(base + index*valueSize, m_numRows, m_numColumns*valueSize, m_type);
+}
+
+std::shared_ptr<ArrayFile> ArrayFile::openRaw(const std::string& fileName, DataType type, std::size_t numColumns, std::size_t headerBytes) {
+	assert(numColumns > 0);
+	auto file = std::make_unique<MappedFile>(fileName);
+	const std::size_t valueSize = type == DataType::FLOAT32 ? sizeof(float) : sizeof(double);
+	if(file->getSize() < headerBytes) {
+		throw std::runtime_error("File \"" + fileName + "\" is smaller than its header!");
+	}
+	std::size_t numRows = (file->getSize() - headerBytes) / (valueSize*numColumns);
+	return std::make_shared<ArrayFile>(std::move(file), headerBytes, type, numRows, numColumns, false);
+}
+
+std::shared_ptr<ArrayFile> ArrayFile::openNpy(const std::string& fileName) {
+	auto file = std::make_unique<MappedFile>(fileName);
+	const uint8_t* data = file->getData();
+	const std::size_t size = file->getSize();
+	auto fail = [&](const std::string& reason) {
+		return std::runtime_error("Invalid .npy file \"" + fileName + "\": " + reason);
+	};
+	// Magic string, version and header length.
+	if(size < 10 || memcmp(data, "\x93NUMPY", 6) != 0) {
+		throw fail("bad magic");
+	}
+	const int major = data[6];
+	std::size_t headerLength = 0;
+	std::size_t headerStart = 0;
+	if(major == 1) {
+		headerLength = std::size_t(data[8]) | (std::size_t(data[9]) << 8);
+		headerStart = 10;
+	} else if((major == 2 || major == 3) && size >= 12) {
+		headerLength = std::size_t(data[8]) | (std::size_t(data[9]) << 8) | (std::size_t(data[10]) << 16) | (std::size_t(data[11]) << 24);
+		headerStart = 12;
+	} else {
+		throw fail("unsupported version");
+	}
+	if(headerStart + headerLength > size) {
+		throw fail("truncated header");
+	}
+	const std::string header((const char*)data + headerStart, headerLength);
+	// Header is a Python dict literal, for example: {'descr': '<f4', 'fortran_order': False, 'shape': (1000, 2), }
+	auto value = [&](const std::string& key) {
+		auto pos = header.find("'" + key + "'");
+		if(pos == std::string::npos) {
+			throw fail("missing " + key);
+		}
+		pos = header.find(':', pos);
+		if(pos == std::string::npos) {
+			throw fail("missing " + key);
+		}
+		return header.substr(pos+1);
+	};
+	DataType type;
+	std::string descr = value("descr");
+	if(descr.find("'<f4'") != std::string::npos || descr.find("'f4'") != std::string::npos) {
+		type = DataType::FLOAT32;
+	} else if(descr.find("'<f8'") != std::string::npos || descr.find("'f8'") != std::string::npos) {
+		type = DataType::FLOAT64;
+	} else {
+		throw fail("only little endian float32 and float64 are supported");
+	}
+	const std::string order = value("fortran_order");
+	const bool columnMajor = order.find("True") < order.find("False");
+	std::string shape = value("shape");
+	shape = shape.substr(shape.find('(')+1);
+	shape = shape.substr(0, shape.find(')'));
+	std::vector<std::size_t> dims;
+	for(std::size_t pos=0; pos<shape.size(); ) {
+		pos = shape.find_first_of("0123456789", pos);
+		if(pos == std::string::npos) {
+			break;
+		}
+		std::size_t end = shape.find_first_not_of("0123456789", pos);
+		dims.push_back(std::stoull(shape.substr(pos, end-pos)));
+		pos = end;
+	}
+	if(dims.empty() || dims.size() > 2) {
+		throw fail("only 1D and 2D arrays are supported");
+	}
+	const std::size_t numRows = dims[0];
+	const std::size_t numColumns = dims.size() == 2 ? dims[1] : 1;
+	const std::size_t valueSize = type == DataType::FLOAT32 ? sizeof(float) : sizeof(double);
+	const std::size_t offset = headerStart + headerLength;
+	if(offset + numRows*numColumns*valueSize > size) {
+		throw fail("truncated data");
+	}
+	return std::make_shared<ArrayFile>(std::move(file), offset, type, numRows, numColumns, columnMajor);
+}
+
+}
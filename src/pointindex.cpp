@@ -0,0 +1,263 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/pointindex.h>
+#include <mikroplot/jobs.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace mikroplot {
+
+namespace {
+	const std::size_t POINTS_PER_CELL = 16;
+	const int MAX_CELLS_PER_AXIS = 4096;
+	const std::size_t MAX_BUILD_CHUNKS = 8;
+	const std::size_t MIN_PENDING = 1024;
+	const uint32_t NO_POINT = ~uint32_t(0);
+
+	bool isValid(const vec2& p) {
+		return !std::isnan(p.x) && !std::isnan(p.y);
+	}
+}
+
+PointIndex::PointIndex(const std::vector<vec2>& points)
+	: m_points(points)
+	, m_numIndexed(0)
+	, m_minX(0), m_minY(0)
+	, m_cellsPerUnitX(0), m_cellsPerUnitY(0)
+	, m_numCellsX(1), m_numCellsY(1)
+	, m_cellStart(2, 0)
+	, m_pendingHead(1, NO_POINT) {
+	build();
+}
+
+PointIndex::PointIndex(const ColumnView& x, const ColumnView& y)
+	: PointIndex() {
+	m_points.resize(std::min(x.size(), y.size()));
+	JobSystem::get().parallelFor("PointIndex::build", 0, m_points.size(), 65536, [&](std::size_t begin, std::size_t end) {
+		for(std::size_t i=begin; i<end; ++i) {
+			m_points[i] = vec2(x[i], y[i]);
+		}
+	});
+	build();
+}
+
+void PointIndex::append(const vec2& point) {
+	m_points.push_back(point);
+	if(m_points.size() - m_numIndexed > std::max(MIN_PENDING, m_numIndexed/8)) {
+		build();
+	} else {
+		insertPending(m_points.size() - 1);
+	}
+}
+
+void PointIndex::append(const std::vector<vec2>& points) {
+	const std::size_t first = m_points.size();
+	m_points.insert(m_points.end(), points.begin(), points.end());
+	if(m_points.size() - m_numIndexed > std::max(MIN_PENDING, m_numIndexed/8)) {
+		build();
+	} else {
+		for(std::size_t i=first; i<m_points.size(); ++i) {
+			insertPending(i);
+		}
+	}
+}
+
+void PointIndex::insertPending(std::size_t i) {
+	m_pendingNext.push_back(NO_POINT);
+	if(!isValid(m_points[i])) {
+		return;
+	}
+	// Points outside the grid bounds go to the edge cells, which are searched before any point beyond them.
+	uint32_t& head = m_pendingHead[std::size_t(cellY(m_points[i].y))*m_numCellsX + cellX(m_points[i].x)];
+	m_pendingNext.back() = head;
+	head = uint32_t(i);
+}
+
+int PointIndex::cellX(float x) const {
+	return std::clamp(int(std::floor((x - m_minX) * m_cellsPerUnitX)), 0, m_numCellsX-1);
+}
+
+int PointIndex::cellY(float y) const {
+	return std::clamp(int(std::floor((y - m_minY) * m_cellsPerUnitY)), 0, m_numCellsY-1);
+}
+
+void PointIndex::build() {
+	auto& jobs = JobSystem::get();
+	const std::size_t count = m_points.size();
+	const std::size_t numChunks = std::max<std::size_t>(1, std::min({jobs.getNumThreads(), MAX_BUILD_CHUNKS, count / 65536}));
+	auto chunkBegin = [&](std::size_t chunk) { return (count * chunk) / numChunks; };
+
+	// Bounds
+	std::vector<std::array<float,4>> bounds(numChunks);
+	jobs.run("PointIndex::build", numChunks, [&](std::size_t chunk) {
+		std::array<float,4> b = {INFINITY, -INFINITY, INFINITY, -INFINITY};
+		for(std::size_t i=chunkBegin(chunk); i<chunkBegin(chunk+1); ++i) {
+			if(isValid(m_points[i])) {
+				b[0] = std::min(b[0], m_points[i].x);
+				b[1] = std::max(b[1], m_points[i].x);
+				b[2] = std::min(b[2], m_points[i].y);
+				b[3] = std::max(b[3], m_points[i].y);
+			}
+		}
+		bounds[chunk] = b;
+	});
+	std::array<float,4> b = {INFINITY, -INFINITY, INFINITY, -INFINITY};
+	for(const auto& chunk : bounds) {
+		b = {std::min(b[0], chunk[0]), std::max(b[1], chunk[1]), std::min(b[2], chunk[2]), std::max(b[3], chunk[3])};
+	}
+	if(b[0] > b[1]) {
+		b = {0, 0, 0, 0};
+	}
+
+	// Grid size: about POINTS_PER_CELL points per cell, cells roughly square in data units.
+	const double width = std::max(double(b[1]) - b[0], 1e-30);
+	const double height = std::max(double(b[3]) - b[2], 1e-30);
+	const double numCells = std::max(1.0, double(count / POINTS_PER_CELL));
+	m_numCellsX = std::clamp(int(std::sqrt(numCells * width / height)), 1, MAX_CELLS_PER_AXIS);
+	m_numCellsY = std::clamp(int(numCells / m_numCellsX), 1, MAX_CELLS_PER_AXIS);
+	m_minX = b[0];
+	m_minY = b[2];
+	m_cellsPerUnitX = float(m_numCellsX / width);
+	m_cellsPerUnitY = float(m_numCellsY / height);
+	const std::size_t cells = std::size_t(m_numCellsX) * std::size_t(m_numCellsY);
+
+	// Parallel counting sort: counts per chunk, offsets per chunk and cell, then scatter.
+	std::vector<uint32_t> offsets(numChunks * cells, 0);
+	jobs.run("PointIndex::build", numChunks, [&](std::size_t chunk) {
+		uint32_t* counts = &offsets[chunk * cells];
+		for(std::size_t i=chunkBegin(chunk); i<chunkBegin(chunk+1); ++i) {
+			if(isValid(m_points[i])) {
+				++counts[cellY(m_points[i].y)*m_numCellsX + cellX(m_points[i].x)];
+			}
+		}
+	});
+	m_cellStart.assign(cells+1, 0);
+	uint32_t total = 0;
+	for(std::size_t cell=0; cell<cells; ++cell) {
+		m_cellStart[cell] = total;
+		for(std::size_t chunk=0; chunk<numChunks; ++chunk) {
+			uint32_t n = offsets[chunk*cells + cell];
+			offsets[chunk*cells + cell] = total;
+			total += n;
+		}
+	}
+	m_cellStart[cells] = total;
+	m_indices.resize(total);
+	jobs.run("PointIndex::build", numChunks, [&](std::size_t chunk) {
+		uint32_t* next = &offsets[chunk * cells];
+		for(std::size_t i=chunkBegin(chunk); i<chunkBegin(chunk+1); ++i) {
+			if(isValid(m_points[i])) {
+				m_indices[next[cellY(m_points[i].y)*m_numCellsX + cellX(m_points[i].x)]++] = uint32_t(i);
+			}
+		}
+	});
+	m_numIndexed = count;
+	m_pendingHead.assign(cells, NO_POINT);
+	m_pendingNext.clear();
+}
+
+std::ptrdiff_t PointIndex::nearest(const vec2& position, float maxDistance, const vec2& scale) const {
+	std::ptrdiff_t best = -1;
+	float bestDistance = maxDistance * maxDistance;
+	auto test = [&](std::size_t i) {
+		const float dx = (m_points[i].x - position.x) * scale.x;
+		const float dy = (m_points[i].y - position.y) * scale.y;
+		const float d = dx*dx + dy*dy;
+		if(d < bestDistance || (d == bestDistance && best < 0)) {
+			bestDistance = d;
+			best = std::ptrdiff_t(i);
+		}
+	};
+	// Search rings of cells around position, until the rest of the grid is further than the best point.
+	const int cx = cellX(position.x);
+	const int cy = cellY(position.y);
+	const float cellWidth = 1.0f / std::max(m_cellsPerUnitX, 1e-30f);
+	const float cellHeight = 1.0f / std::max(m_cellsPerUnitY, 1e-30f);
+	for(int r=0; ; ++r) {
+		const int x0 = cx-r, x1 = cx+r, y0 = cy-r, y1 = cy+r;
+		auto searchCell = [&](int x, int y) {
+			const std::size_t cell = std::size_t(y)*m_numCellsX + x;
+			for(uint32_t j=m_cellStart[cell]; j<m_cellStart[cell+1]; ++j) {
+				test(m_indices[j]);
+			}
+			for(uint32_t i=m_pendingHead[cell]; i != NO_POINT; i = m_pendingNext[i - m_numIndexed]) {
+				test(i);
+			}
+		};
+		for(int y=std::max(y0, 0); y<=std::min(y1, m_numCellsY-1); ++y) {
+			if(y == y0 || y == y1) {
+				for(int x=std::max(x0, 0); x<=std::min(x1, m_numCellsX-1); ++x) {
+					searchCell(x, y);
+				}
+			} else {
+				if(x0 >= 0) searchCell(x0, y);
+				if(x1 < m_numCellsX) searchCell(x1, y);
+			}
+		}
+		// Lower bound of distance to cells outside searched rectangle.
+		float bound = INFINITY;
+		if(x0 > 0) bound = std::min(bound, std::max(0.0f, position.x - (m_minX + x0*cellWidth)) * std::abs(scale.x));
+		if(x1 < m_numCellsX-1) bound = std::min(bound, std::max(0.0f, (m_minX + (x1+1)*cellWidth) - position.x) * std::abs(scale.x));
+		if(y0 > 0) bound = std::min(bound, std::max(0.0f, position.y - (m_minY + y0*cellHeight)) * std::abs(scale.y));
+		if(y1 < m_numCellsY-1) bound = std::min(bound, std::max(0.0f, (m_minY + (y1+1)*cellHeight) - position.y) * std::abs(scale.y));
+		if(std::isinf(bound) || bound*bound >= bestDistance) {
+			break;
+		}
+	}
+	return best;
+}
+
+void PointIndex::query(float left, float right, float bottom, float top, std::vector<std::size_t>& result) const {
+	if(left > right) std::swap(left, right);
+	if(bottom > top) std::swap(bottom, top);
+	auto inside = [&](const vec2& p) {
+		return p.x >= left && p.x <= right && p.y >= bottom && p.y <= top;
+	};
+	const std::size_t first = result.size();
+	const int x0 = cellX(left), x1 = cellX(right);
+	const int y0 = cellY(bottom), y1 = cellY(top);
+	for(int y=y0; y<=y1; ++y) {
+		for(int x=x0; x<=x1; ++x) {
+			const std::size_t cell = std::size_t(y)*m_numCellsX + x;
+			for(uint32_t j=m_cellStart[cell]; j<m_cellStart[cell+1]; ++j) {
+				if(inside(m_points[m_indices[j]])) {
+					result.push_back(m_indices[j]);
+				}
+			}
+			for(uint32_t i=m_pendingHead[cell]; i != NO_POINT; i = m_pendingNext[i - m_numIndexed]) {
+				if(inside(m_points[i])) {
+					result.push_back(i);
+				}
+			}
+		}
+	}
+	// Cells are visited in grid order: sort to the order the points were added.
+	std::sort(result.begin() + std::ptrdiff_t(first), result.end());
+}
+
+}
@@ -0,0 +1,260 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/poster.h>
+#include <mikroplot/jobs.h>
+#include <algorithm>
+#include <cstring>
+#if defined(MIKROPLOT_USE_ZLIB)
+#include <zlib.h>
+#endif
+
+namespace mikroplot {
+
+namespace {
+	// Size of IDAT chunks.
+	const std::size_t CHUNK_SIZE = 1 << 18;
+#if !defined(MIKROPLOT_USE_ZLIB)
+	// Largest stored deflate block.
+	const std::size_t STORED_BLOCK_SIZE = 65535;
+#endif
+
+	uint32_t crc32Table(uint32_t index) {
+		uint32_t c = index;
+		for(int k=0; k<8; ++k) {
+			c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : (c >> 1);
+		}
+		return c;
+	}
+
+	uint32_t updateCrc(uint32_t crc, const uint8_t* data, std::size_t size) {
+		static const auto table = []() {
+			std::vector<uint32_t> t(256);
+			for(uint32_t i=0; i<256; ++i) {
+				t[i] = crc32Table(i);
+			}
+			return t;
+		}();
+		for(std::size_t i=0; i<size; ++i) {
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return crc;
+	}
+
+	void putBigEndian(uint8_t* dst, uint32_t value) {
+		dst[0] = uint8_t(value >> 24);
+		dst[1] = uint8_t(value >> 16);
+		dst[2] = uint8_t(value >> 8);
+		dst[3] = uint8_t(value);
+	}
+}
+
+#if defined(MIKROPLOT_USE_ZLIB)
+struct PngWriter::Deflate {
+	z_stream stream;
+};
+#else
+struct PngWriter::Deflate {
+	uint32_t adlerA = 1;
+	uint32_t adlerB = 0;
+};
+#endif
+
+PngWriter::PngWriter()
+	: m_file(0)
+	, m_width(0)
+	, m_height(0)
+	, m_channels(0)
+	, m_rowsWritten(0)
+	, m_ok(false) {
+}
+
+PngWriter::~PngWriter() {
+#if defined(MIKROPLOT_USE_ZLIB)
+	if(m_deflate) {
+		deflateEnd(&m_deflate->stream);
+	}
+#endif
+	if(m_file) {
+		fclose(m_file);
+	}
+}
+
+bool PngWriter::open(const std::string& fileName, int width, int height, int channels, int compression) {
+	if(width <= 0 || height <= 0 || (channels != 3 && channels != 4)) {
+		return false;
+	}
+	m_file = fopen(fileName.c_str(), "wb");
+	if(!m_file) {
+		return false;
+	}
+	m_width = width;
+	m_height = height;
+	m_channels = channels;
+	m_ok = true;
+	m_deflate = std::make_unique<Deflate>();
+#if defined(MIKROPLOT_USE_ZLIB)
+	memset(&m_deflate->stream, 0, sizeof(m_deflate->stream));
+	if(deflateInit(&m_deflate->stream, std::clamp(compression, 0, 9)) != Z_OK) {
+		m_deflate = 0;
+		return m_ok = false;
+	}
+#else
+	(void)compression;
+	// zlib header: deflate, 32K window, no compression.
+	m_output.push_back(0x78);
+	m_output.push_back(0x01);
+#endif
+	static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	m_ok = fwrite(SIGNATURE, 1, sizeof(SIGNATURE), m_file) == sizeof(SIGNATURE);
+	uint8_t header[13];
+	putBigEndian(header, uint32_t(width));
+	putBigEndian(header + 4, uint32_t(height));
+	header[8] = 8;							// Bit depth
+	header[9] = channels == 3 ? 2 : 6;		// Truecolor or truecolor with alpha
+	header[10] = 0;							// Deflate
+	header[11] = 0;							// Adaptive filtering
+	header[12] = 0;							// No interlace
+	return writeChunk("IHDR", header, sizeof(header)) && m_ok;
+}
+
+bool PngWriter::writeRows(const uint8_t* rows, int numRows) {
+	if(!m_ok || m_rowsWritten + numRows > m_height) {
+		return m_ok = false;
+	}
+	// Sub filter: each byte minus the same channel of the pixel on the left.
+	const std::size_t rowSize = std::size_t(m_width) * std::size_t(m_channels);
+	m_filtered.resize(std::size_t(numRows) * (rowSize + 1));
+	JobSystem::get().parallelFor("PngWriter::filter", 0, std::size_t(numRows), 16, [&](std::size_t begin, std::size_t end) {
+		for(std::size_t y=begin; y<end; ++y) {
+			const uint8_t* src = rows + y*rowSize;
+			uint8_t* dst = &m_filtered[y*(rowSize + 1)];
+			dst[0] = 1;
+			for(std::size_t i=0; i<rowSize; ++i) {
+				dst[1 + i] = uint8_t(src[i] - (i >= std::size_t(m_channels) ? src[i - m_channels] : 0));
+			}
+		}
+	});
+	m_rowsWritten += numRows;
+	return compress(m_filtered.data(), m_filtered.size(), false);
+}
+
+bool PngWriter::finish() {
+	if(!m_file) {
+		return false;
+	}
+	m_ok = m_ok && m_rowsWritten == m_height && compress(0, 0, true);
+	m_ok = m_ok && writeChunk("IEND", 0, 0);
+	m_ok = (fclose(m_file) == 0) && m_ok;
+	m_file = 0;
+	return m_ok;
+}
+
+#if defined(MIKROPLOT_USE_ZLIB)
+bool PngWriter::compress(const uint8_t* data, std::size_t size, bool last) {
+	auto& stream = m_deflate->stream;
+	stream.next_in = (Bytef*)data;
+	stream.avail_in = uInt(size);
+	int status = Z_OK;
+	do {
+		const std::size_t used = m_output.size();
+		m_output.resize(CHUNK_SIZE);
+		stream.next_out = m_output.data() + used;
+		stream.avail_out = uInt(CHUNK_SIZE - used);
+		status = deflate(&stream, last ? Z_FINISH : Z_NO_FLUSH);
+		if(status == Z_STREAM_ERROR) {
+			return m_ok = false;
+		}
+		m_output.resize(CHUNK_SIZE - stream.avail_out);
+		if(m_output.size() == CHUNK_SIZE || (last && status == Z_STREAM_END)) {
+			if(!writeChunk("IDAT", m_output.data(), m_output.size())) {
+				return false;
+			}
+			m_output.clear();
+		}
+	} while(stream.avail_in > 0 || (last && status != Z_STREAM_END));
+	return m_ok;
+}
+#else
+bool PngWriter::compress(const uint8_t* data, std::size_t size, bool last) {
+	auto& d = *m_deflate;
+	for(std::size_t begin=0; begin<size; ) {
+		const std::size_t count = std::min(STORED_BLOCK_SIZE, size - begin);
+		const uint8_t header[5] = {0, uint8_t(count), uint8_t(count >> 8), uint8_t(~count), uint8_t(~count >> 8)};
+		m_output.insert(m_output.end(), header, header + 5);
+		m_output.insert(m_output.end(), data + begin, data + begin + count);
+		// Adler-32, reduced often enough to avoid overflow.
+		for(std::size_t i=0; i<count; i += 4096) {
+			const std::size_t n = std::min<std::size_t>(4096, count - i);
+			for(std::size_t j=0; j<n; ++j) {
+				d.adlerA += data[begin + i + j];
+				d.adlerB += d.adlerA;
+			}
+			d.adlerA %= 65521;
+			d.adlerB %= 65521;
+		}
+		begin += count;
+		if(m_output.size() >= CHUNK_SIZE) {
+			if(!writeChunk("IDAT", m_output.data(), m_output.size())) {
+				return false;
+			}
+			m_output.clear();
+		}
+	}
+	if(last) {
+		// Empty final block and checksum.
+		const uint8_t final[5] = {1, 0, 0, 0xFF, 0xFF};
+		m_output.insert(m_output.end(), final, final + 5);
+		uint8_t adler[4];
+		putBigEndian(adler, (d.adlerB << 16) | d.adlerA);
+		m_output.insert(m_output.end(), adler, adler + 4);
+		if(!writeChunk("IDAT", m_output.data(), m_output.size())) {
+			return false;
+		}
+		m_output.clear();
+	}
+	return m_ok;
+}
+#endif
+
+bool PngWriter::writeChunk(const char type[4], const uint8_t* data, std::size_t size) {
+	uint8_t length[4];
+	putBigEndian(length, uint32_t(size));
+	uint32_t crc = updateCrc(0xFFFFFFFFu, (const uint8_t*)type, 4);
+	if(size > 0) {
+		crc = updateCrc(crc, data, size);
+	}
+	uint8_t crcBytes[4];
+	putBigEndian(crcBytes, crc ^ 0xFFFFFFFFu);
+	m_ok = m_ok
+		&& fwrite(length, 1, 4, m_file) == 4
+		&& fwrite(type, 1, 4, m_file) == 4
+		&& (size == 0 || fwrite(data, 1, size, m_file) == size)
+		&& fwrite(crcBytes, 1, 4, m_file) == 4;
+	return m_ok;
+}
+
+}
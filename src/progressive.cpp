@@ -0,0 +1,67 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/progressive.h>
+#include <mikroplot/framebuffer.h>
+#include <glad/gl.h>
+
+namespace mikroplot {
+
+ProgressiveShade::ProgressiveShade()
+	: m_nextTile(0)
+	, m_tileMilliseconds(0.0) {
+	for(int i=0; i<NUM_QUERIES; ++i) {
+		m_queries[i] = 0;
+		m_queryTiles[i] = 0;
+	}
+}
+
+ProgressiveShade::~ProgressiveShade() {
+	if(m_queries[0]) {
+		glDeleteQueries(NUM_QUERIES, m_queries);
+	}
+}
+
+void ProgressiveShade::collectQueries() {
+	for(int i=0; i<NUM_QUERIES; ++i) {
+		if(m_queryTiles[i] == 0) {
+			continue;
+		}
+		GLint available = 0;
+		glGetQueryObjectiv(m_queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if(!available) {
+			continue;
+		}
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(m_queries[i], GL_QUERY_RESULT, &nanoseconds);
+		const double milliseconds = 1e-6*double(nanoseconds) / double(m_queryTiles[i]);
+		// Moving average: cost of tiles varies with their content.
+		m_tileMilliseconds = m_tileMilliseconds > 0.0 ? 0.5*(m_tileMilliseconds + milliseconds) : milliseconds;
+		m_queryTiles[i] = 0;
+	}
+}
+
+}
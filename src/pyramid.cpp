@@ -0,0 +1,327 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/pyramid.h>
+#include <mikroplot/jobs.h>
+#include <algorithm>
+#include <fstream>
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+
+namespace mikroplot {
+
+namespace {
+	const char PYRAMID_MAGIC[4] = {'M','P','Y','R'};
+	const uint32_t PYRAMID_VERSION = 3;
+
+	struct PyramidHeader {
+		char     magic[4];
+		uint32_t version;
+		uint64_t count;
+		uint64_t leafSize;
+		uint64_t branching;
+		uint64_t numLevels;
+		uint64_t sampledHash;	// Of evenly spaced samples, checked on every load.
+		uint64_t checksum;		// Of all samples, checked on load only on request.
+	};
+
+	// Number of buckets per job.
+	const std::size_t BUCKET_GRAIN = 4096;
+	// Number of samples per checksum chunk. Fixed, so that the checksum does not depend on the number of threads.
+	const std::size_t CHECKSUM_CHUNK = 1 << 16;
+	// Number of samples in the sampled hash.
+	const std::size_t HASH_SAMPLES = 4096;
+
+	inline uint64_t hashValue(uint64_t hash, double value) {
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return (hash ^ bits) * 0x100000001b3ull;
+	}
+
+	// FNV-1a style hash of at most HASH_SAMPLES evenly spaced samples: constant time, even for huge series.
+	uint64_t sampledHash(const ColumnView& values) {
+		const std::size_t count = values.size();
+		uint64_t hash = 0xcbf29ce484222325ull ^ count;
+		if(count == 0) {
+			return hash;
+		}
+		const std::size_t n = std::min(count, HASH_SAMPLES);
+		values.visit([&](auto view) {
+			for(std::size_t k=0; k<n; ++k) {
+				const std::size_t i = n > 1 ? std::size_t((uint64_t(k)*uint64_t(count-1)) / uint64_t(n-1)) : 0;
+				hash = hashValue(hash, double(view[i]));
+			}
+		});
+		return hash;
+	}
+
+	// FNV-1a style hash of the samples as doubles, computed in parallel chunks.
+	uint64_t checksum(const ColumnView& values) {
+		const std::size_t count = values.size();
+		const std::size_t numChunks = (count + CHECKSUM_CHUNK - 1) / CHECKSUM_CHUNK;
+		std::vector<uint64_t> hashes(numChunks);
+		values.visit([&](auto view) {
+			JobSystem::get().run("SeriesPyramid::checksum", numChunks, [&](std::size_t chunk) {
+				const std::size_t end = std::min(count, (chunk + 1)*CHECKSUM_CHUNK);
+				uint64_t hash = 0xcbf29ce484222325ull;
+				for(std::size_t i=chunk*CHECKSUM_CHUNK; i<end; ++i) {
+					hash = hashValue(hash, double(view[i]));
+				}
+				hashes[chunk] = hash;
+			});
+		});
+		uint64_t hash = count;
+		for(auto h : hashes) {
+			hash = (hash * 0x9e3779b97f4a7c15ull) ^ h;
+		}
+		return hash;
+	}
+}
+
+SeriesPyramid::SeriesPyramid(const float* values, std::size_t count, double x0, double dx, std::size_t leafSize, std::size_t branching)
+	: SeriesPyramid(ColumnView(values, count), x0, dx, leafSize, branching) {
+}
+
+SeriesPyramid::SeriesPyramid(const ColumnView& values, double x0, double dx, std::size_t leafSize, std::size_t branching)
+	: m_values(values)
+	, m_count(values.size())
+	, m_x0(x0)
+	, m_dx(dx)
+	, m_leafSize(std::max<std::size_t>(2, leafSize))
+	, m_branching(std::max<std::size_t>(2, branching)) {
+	assert(dx > 0.0);
+}
+
+void SeriesPyramid::build() {
+	m_levels.clear();
+	if(m_count == 0) {
+		return;
+	}
+	// Level 0 from raw samples.
+	Level leaf;
+	leaf.bucketSize = m_leafSize;
+	std::size_t numBuckets = (m_count + m_leafSize - 1) / m_leafSize;
+	leaf.mins.resize(numBuckets);
+	leaf.maxs.resize(numBuckets);
+	m_values.visit([&](auto values) {
+		JobSystem::get().parallelFor("SeriesPyramid::build", 0, numBuckets, BUCKET_GRAIN, [&](std::size_t begin, std::size_t end) {
+			for(std::size_t b=begin; b<end; ++b) {
+				const std::size_t first = b*m_leafSize;
+				const std::size_t last = std::min(first + m_leafSize, m_count);
+				auto mn = values[first];
+				auto mx = values[first];
+				for(std::size_t i=first+1; i<last; ++i) {
+					mn = std::min(mn, values[i]);
+					mx = std::max(mx, values[i]);
+				}
+				leaf.mins[b] = float(mn);
+				leaf.maxs[b] = float(mx);
+			}
+		});
+	});
+	m_levels.push_back(std::move(leaf));
+
+	// Upper levels from previous level.
+	while(m_levels.back().mins.size() > 1) {
+		const Level& prev = m_levels.back();
+		Level level;
+		level.bucketSize = prev.bucketSize * m_branching;
+		numBuckets = (prev.mins.size() + m_branching - 1) / m_branching;
+		level.mins.resize(numBuckets);
+		level.maxs.resize(numBuckets);
+		JobSystem::get().parallelFor("SeriesPyramid::build", 0, numBuckets, BUCKET_GRAIN, [&](std::size_t begin, std::size_t end) {
+			for(std::size_t b=begin; b<end; ++b) {
+				const std::size_t first = b*m_branching;
+				const std::size_t last = std::min(first + m_branching, prev.mins.size());
+				level.mins[b] = *std::min_element(&prev.mins[first], &prev.mins[0] + last);
+				level.maxs[b] = *std::max_element(&prev.maxs[first], &prev.maxs[0] + last);
+			}
+		});
+		m_levels.push_back(std::move(level));
+	}
+}
+
+bool SeriesPyramid::save(const std::string& fileName) const {
+	std::ofstream f(fileName, std::ios::binary);
+	if(!f) {
+		return false;
+	}
+	PyramidHeader header;
+	memcpy(header.magic, PYRAMID_MAGIC, sizeof(header.magic));
+	header.version = PYRAMID_VERSION;
+	header.count = m_count;
+	header.leafSize = m_leafSize;
+	header.branching = m_branching;
+	header.numLevels = m_levels.size();
+	header.sampledHash = sampledHash(m_values);
+	header.checksum = checksum(m_values);
+	f.write((const char*)&header, sizeof(header));
+	for(const auto& level : m_levels) {
+		uint64_t size[2] = {level.bucketSize, level.mins.size()};
+		f.write((const char*)size, sizeof(size));
+		f.write((const char*)level.mins.data(), level.mins.size()*sizeof(float));
+		f.write((const char*)level.maxs.data(), level.maxs.size()*sizeof(float));
+	}
+	return bool(f);
+}
+
+bool SeriesPyramid::load(const std::string& fileName, bool verifyAll) {
+	std::ifstream f(fileName, std::ios::binary);
+	if(!f) {
+		return false;
+	}
+	PyramidHeader header;
+	if(!f.read((char*)&header, sizeof(header))
+		|| memcmp(header.magic, PYRAMID_MAGIC, sizeof(header.magic)) != 0
+		|| header.version != PYRAMID_VERSION
+		|| header.count != m_count
+		|| header.leafSize != m_leafSize
+		|| header.branching != m_branching
+		|| header.sampledHash != sampledHash(m_values)
+		|| (verifyAll && header.checksum != checksum(m_values))) {
+		return false;
+	}
+	std::vector<Level> levels(header.numLevels);
+	for(auto& level : levels) {
+		uint64_t size[2];
+		if(!f.read((char*)size, sizeof(size))) {
+			return false;
+		}
+		level.bucketSize = size[0];
+		level.mins.resize(size[1]);
+		level.maxs.resize(size[1]);
+		f.read((char*)level.mins.data(), level.mins.size()*sizeof(float));
+		f.read((char*)level.maxs.data(), level.maxs.size()*sizeof(float));
+	}
+	if(!f) {
+		return false;
+	}
+	m_levels = std::move(levels);
+	return true;
+}
+
+void SeriesPyramid::loadOrBuild(const std::string& fileName, bool verifyAll) {
+	if(!load(fileName, verifyAll)) {
+		build();
+		save(fileName);
+	}
+}
+
+std::size_t SeriesPyramid::getIndexSize() const {
+	std::size_t size = 0;
+	for(const auto& level : m_levels) {
+		size += (level.mins.size() + level.maxs.size()) * sizeof(float);
+	}
+	return size;
+}
+
+std::vector<vec2> SeriesPyramid::query(double left, double right, std::size_t columns) const {
+	std::vector<vec2> result;
+	if(m_count == 0 || columns == 0 || !(left < right)) {
+		return result;
+	}
+	auto sampleX = [&](double i) {
+		return float(m_x0 + i*m_dx);
+	};
+	// Visible sample range [i0, i1)
+	const double first = std::ceil((left - m_x0) / m_dx);
+	const double last = std::floor((right - m_x0) / m_dx) + 1.0;
+	const std::size_t i0 = std::size_t(std::clamp(first, 0.0, double(m_count)));
+	const std::size_t i1 = std::size_t(std::clamp(last, 0.0, double(m_count)));
+	if(i0 >= i1) {
+		return result;
+	}
+	const double samplesPerColumn = double(i1 - i0) / double(columns);
+
+	if(i0 > 0) {
+		result.push_back(vec2(sampleX(double(i0-1)), m_values[i0-1]));
+	}
+	if(samplesPerColumn <= 2.0) {
+		// Zoomed in to sample level
+		for(std::size_t i=i0; i<i1; ++i) {
+			result.push_back(vec2(sampleX(double(i)), m_values[i]));
+		}
+	} else {
+		// Coarsest level, which has at least one bucket per column. Raw samples if there is none.
+		const Level* level = 0;
+		for(const auto& l : m_levels) {
+			if(double(l.bucketSize) <= samplesPerColumn) {
+				level = &l;
+			}
+		}
+		std::vector<float> mins(columns);
+		std::vector<float> maxs(columns);
+		std::vector<char> valid(columns, 0);
+		JobSystem::get().parallelFor("SeriesPyramid::query", 0, columns, 64, [&](std::size_t begin, std::size_t end) {
+			for(std::size_t c=begin; c<end; ++c) {
+				std::size_t s0 = i0 + std::size_t(double(c) * samplesPerColumn);
+				std::size_t s1 = std::min(i1, i0 + std::size_t(double(c+1) * samplesPerColumn));
+				if(s0 >= s1) {
+					continue;
+				}
+				float mn, mx;
+				if(level) {
+					std::size_t b0 = s0 / level->bucketSize;
+					std::size_t b1 = (s1 + level->bucketSize - 1) / level->bucketSize;
+					mn = *std::min_element(&level->mins[b0], &level->mins[0] + b1);
+					mx = *std::max_element(&level->maxs[b0], &level->maxs[0] + b1);
+				} else {
+					mn = mx = m_values[s0];
+					for(std::size_t i=s0+1; i<s1; ++i) {
+						mn = std::min(mn, m_values[i]);
+						mx = std::max(mx, m_values[i]);
+					}
+				}
+				mins[c] = mn;
+				maxs[c] = mx;
+				valid[c] = 1;
+			}
+		});
+		// Two points per column. Order them so that the strip continues from the closer one.
+		float prevY = result.empty() ? 0.0f : result.back().y;
+		for(std::size_t c=0; c<columns; ++c) {
+			if(!valid[c]) {
+				continue;
+			}
+			float x = sampleX(double(i0) + (double(c)+0.5) * samplesPerColumn);
+			if(std::abs(mins[c] - prevY) <= std::abs(maxs[c] - prevY)) {
+				result.push_back(vec2(x, mins[c]));
+				result.push_back(vec2(x, maxs[c]));
+			} else {
+				result.push_back(vec2(x, maxs[c]));
+				result.push_back(vec2(x, mins[c]));
+			}
+			prevY = result.back().y;
+		}
+	}
+	if(i1 < m_count) {
+		result.push_back(vec2(sampleX(double(i1)), m_values[i1]));
+	}
+	return result;
+}
+
+}
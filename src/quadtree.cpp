@@ -0,0 +1,150 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/quadtree.h>
+#include <mikroplot/jobs.h>
+#include <algorithm>
+#include <memory>
+#include <functional>
+#include <cmath>
+
+namespace mikroplot {
+
+namespace {
+	const int MAX_DEPTH = 24;
+	// Subtrees are built in parallel down to this depth.
+	const int PARALLEL_DEPTH = 3;
+
+	std::array<float,4> boundsOf(const vec2* begin, const vec2* end) {
+		std::array<float,4> b = {INFINITY, -INFINITY, INFINITY, -INFINITY};
+		for(const vec2* p = begin; p != end; ++p) {
+			b[0] = std::min(b[0], p->x);
+			b[1] = std::max(b[1], p->x);
+			b[2] = std::min(b[2], p->y);
+			b[3] = std::max(b[3], p->y);
+		}
+		return b;
+	}
+}
+
+PointQuadtree::PointQuadtree(const std::vector<vec2>& points, std::size_t leafSize, std::size_t sampleSize)
+	: m_points(points)
+	, m_leafSize(std::max<std::size_t>(leafSize, 1))
+	, m_sampleSize(std::max<std::size_t>(sampleSize, 1)) {
+	// NaN points can not be placed into any quadrant.
+	m_points.erase(std::remove_if(m_points.begin(), m_points.end(), [](const vec2& p) { return std::isnan(p.x) || std::isnan(p.y); }), m_points.end());
+
+	// Subtrees are built to temporary nodes in parallel and flattened afterwards.
+	struct BuildNode {
+		Node                                      node;
+		std::array<std::unique_ptr<BuildNode>, 4> children;
+	};
+	std::function<void(BuildNode&, uint32_t, uint32_t, int)> buildNode = [&](BuildNode& result, uint32_t begin, uint32_t end, int depth) {
+		Node& node = result.node;
+		node.begin = begin;
+		node.end = end;
+		node.children = {-1, -1, -1, -1};
+		node.bounds = boundsOf(&m_points[0] + begin, &m_points[0] + end);
+		const std::size_t stride = (end - begin + m_sampleSize - 1) / m_sampleSize;
+		for(uint32_t i=begin; i<end; i += uint32_t(stride)) {
+			node.sample.push_back(m_points[i]);
+		}
+		// Leaf, or all points are duplicates.
+		if(end - begin <= m_leafSize || depth >= MAX_DEPTH || (node.bounds[0] == node.bounds[1] && node.bounds[2] == node.bounds[3])) {
+			return;
+		}
+		// Partition to quadrants around the center of the bounds: bottom/top, then left/right.
+		const float cx = 0.5f*(node.bounds[0] + node.bounds[1]);
+		const float cy = 0.5f*(node.bounds[2] + node.bounds[3]);
+		auto first = m_points.begin() + begin;
+		auto last = m_points.begin() + end;
+		auto midY = std::partition(first, last, [&](const vec2& p) { return p.y < cy; });
+		auto midX0 = std::partition(first, midY, [&](const vec2& p) { return p.x < cx; });
+		auto midX1 = std::partition(midY, last, [&](const vec2& p) { return p.x < cx; });
+		const uint32_t bounds[5] = {begin, uint32_t(midX0 - m_points.begin()), uint32_t(midY - m_points.begin()), uint32_t(midX1 - m_points.begin()), end};
+		auto buildChild = [&](std::size_t quadrant) {
+			if(bounds[quadrant+1] > bounds[quadrant]) {
+				result.children[quadrant] = std::make_unique<BuildNode>();
+				buildNode(*result.children[quadrant], bounds[quadrant], bounds[quadrant+1], depth+1);
+			}
+		};
+		if(depth < PARALLEL_DEPTH) {
+			JobSystem::get().run("PointQuadtree::build", 4, buildChild);
+		} else {
+			for(std::size_t quadrant=0; quadrant<4; ++quadrant) {
+				buildChild(quadrant);
+			}
+		}
+	};
+	BuildNode root;
+	buildNode(root, 0, uint32_t(m_points.size()), 0);
+
+	// Flatten depth first.
+	std::function<int32_t(BuildNode&)> flatten = [&](BuildNode& buildNode) {
+		int32_t index = int32_t(m_nodes.size());
+		m_nodes.push_back(std::move(buildNode.node));
+		for(std::size_t quadrant=0; quadrant<4; ++quadrant) {
+			if(buildNode.children[quadrant]) {
+				int32_t child = flatten(*buildNode.children[quadrant]);
+				m_nodes[index].children[quadrant] = child;
+			}
+		}
+		return index;
+	};
+	flatten(root);
+}
+
+std::vector<vec2> PointQuadtree::query(float left, float right, float bottom, float top, int widthPx, int heightPx, float pointsPerPixel) const {
+	std::vector<vec2> result;
+	if(left > right) std::swap(left, right);
+	if(bottom > top) std::swap(bottom, top);
+	const float pixelsPerUnitX = float(widthPx) / std::max(right - left, 1e-30f);
+	const float pixelsPerUnitY = float(heightPx) / std::max(top - bottom, 1e-30f);
+
+	std::vector<int32_t> stack = {0};
+	while(!stack.empty()) {
+		const Node& node = m_nodes[stack.back()];
+		stack.pop_back();
+		if(node.begin == node.end || node.bounds[1] < left || node.bounds[0] > right || node.bounds[3] < bottom || node.bounds[2] > top) {
+			continue;
+		}
+		const float area = std::max(1.0f, (node.bounds[1]-node.bounds[0]) * pixelsPerUnitX) * std::max(1.0f, (node.bounds[3]-node.bounds[2]) * pixelsPerUnitY);
+		const std::size_t count = node.end - node.begin;
+		const bool leaf = node.children == std::array<int32_t,4>{-1, -1, -1, -1};
+		if(count > node.sample.size() && area * pointsPerPixel <= float(node.sample.size())) {
+			result.insert(result.end(), node.sample.begin(), node.sample.end());
+		} else if(leaf) {
+			result.insert(result.end(), m_points.begin() + node.begin, m_points.begin() + node.end);
+		} else {
+			for(auto child : node.children) {
+				if(child >= 0) stack.push_back(child);
+			}
+		}
+	}
+	return result;
+}
+
+}
@@ -0,0 +1,235 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/range.h>
+#include <mikroplot/jobs.h>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <stdint.h>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIKROPLOT_SSE2 1
+#endif
+
+namespace mikroplot {
+
+namespace range {
+
+namespace {
+	const std::size_t NUM_KEYS = 65536;
+
+	// Order preserving mapping of float bits to unsigned integer.
+	inline uint32_t toKey(float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+	}
+
+	inline float fromKey(uint32_t key) {
+		uint32_t bits = (key & 0x80000000u) ? (key & 0x7fffffffu) : ~key;
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	struct Partial {
+		float                 min = INFINITY;
+		float                 max = -INFINITY;
+		std::vector<uint32_t> histogram;
+	};
+
+	// Accumulates values to partial result. Copies values to dst, if it is not null.
+	void accumulateBlock(const float* values, std::size_t count, float* dst, Partial& partial) {
+		std::size_t i = 0;
+#if defined(MIKROPLOT_SSE2)
+		// _mm_min_ps returns the second operand, when either one is NaN: NaNs are skipped.
+		__m128 mins = _mm_set1_ps(partial.min);
+		__m128 maxs = _mm_set1_ps(partial.max);
+		for(; i+4 <= count; i += 4) {
+			__m128 v = _mm_loadu_ps(values + i);
+			mins = _mm_min_ps(v, mins);
+			maxs = _mm_max_ps(v, maxs);
+			if(dst) {
+				_mm_storeu_ps(dst + i, v);
+			}
+		}
+		float lanes[8];
+		_mm_storeu_ps(lanes, mins);
+		_mm_storeu_ps(lanes+4, maxs);
+		partial.min = std::min({lanes[0], lanes[1], lanes[2], lanes[3]});
+		partial.max = std::max({lanes[4], lanes[5], lanes[6], lanes[7]});
+#endif
+		for(; i<count; ++i) {
+			if(values[i] == values[i]) {
+				partial.min = std::min(partial.min, values[i]);
+				partial.max = std::max(partial.max, values[i]);
+			}
+			if(dst) {
+				dst[i] = values[i];
+			}
+		}
+		if(!partial.histogram.empty()) {
+			for(std::size_t j=0; j<count; ++j) {
+				if(values[j] == values[j]) {
+					++partial.histogram[toKey(values[j]) >> 16];
+				}
+			}
+		}
+	}
+
+	// Values are processed in L1 sized blocks, so that the histogram pass reads cached data.
+	void accumulate(const float* values, std::size_t count, float* dst, Partial& partial) {
+		const std::size_t BLOCK_SIZE = 4096;
+		for(std::size_t i=0; i<count; i += BLOCK_SIZE) {
+			accumulateBlock(values + i, std::min(BLOCK_SIZE, count - i), dst ? dst + i : nullptr, partial);
+		}
+	}
+
+	ValueRange finish(std::vector<Partial>& partials, const RangeOptions& options) {
+		ValueRange result;
+		float min = INFINITY;
+		float max = -INFINITY;
+		for(const auto& partial : partials) {
+			min = std::min(min, partial.min);
+			max = std::max(max, partial.max);
+		}
+		if(min > max) {
+			return result;
+		}
+		result.min = min;
+		result.max = max;
+		if(options.mode != AutoRange::MIN_MAX) {
+			// Cumulative histogram of keys.
+			std::vector<uint64_t> cumulative(NUM_KEYS+1, 0);
+			for(std::size_t key=0; key<NUM_KEYS; ++key) {
+				uint64_t count = 0;
+				for(const auto& partial : partials) {
+					count += partial.histogram[key];
+				}
+				cumulative[key+1] = cumulative[key] + count;
+			}
+			const uint64_t total = cumulative[NUM_KEYS];
+			auto percentile = [&](float p, bool upper) {
+				const uint64_t rank = uint64_t(std::clamp(p / 100.0f, 0.0f, 1.0f) * double(total));
+				std::size_t key = std::size_t(std::upper_bound(cumulative.begin(), cumulative.end(), rank) - cumulative.begin()) - 1;
+				key = std::min(key, NUM_KEYS-1);
+				return std::clamp(fromKey(uint32_t(key << 16) | (upper ? 0xffffu : 0u)), min, max);
+			};
+			result.min = percentile(options.lowPercentile, false);
+			result.max = std::max(result.min, percentile(options.highPercentile, true));
+
+			if(options.mode == AutoRange::EQUALIZE && result.max > result.min && options.lutSize > 1) {
+				const uint64_t low = cumulative[toKey(result.min) >> 16];
+				const uint64_t high = cumulative[(toKey(result.max) >> 16) + 1];
+				const double range = double(std::max<uint64_t>(high - low, 1));
+				result.lut.resize(options.lutSize);
+				for(std::size_t i=0; i<options.lutSize; ++i) {
+					const float value = result.min + (result.max - result.min) * float(i) / float(options.lutSize - 1);
+					const std::size_t key = toKey(value) >> 16;
+					// Half of the values of the own bin are below value.
+					const double below = double(cumulative[key] - std::min(cumulative[key], low)) + 0.5*double(cumulative[key+1] - cumulative[key]);
+					result.lut[i] = float(std::clamp(below / range, 0.0, 1.0));
+				}
+				// Keep lookup table monotonic and spanning the whole color range.
+				result.lut.front() = 0.0f;
+				result.lut.back() = 1.0f;
+				for(std::size_t i=1; i<result.lut.size(); ++i) {
+					result.lut[i] = std::max(result.lut[i], result.lut[i-1]);
+				}
+			}
+		}
+		return result;
+	}
+
+	std::vector<Partial> makePartials(std::size_t count, const RangeOptions& options) {
+		std::vector<Partial> partials(count);
+		if(options.mode != AutoRange::MIN_MAX) {
+			for(auto& partial : partials) {
+				partial.histogram.assign(NUM_KEYS, 0);
+			}
+		}
+		return partials;
+	}
+
+	// Number of values per job.
+	const std::size_t VALUE_GRAIN = 65536;
+}
+
+ValueRange compute(const float* values, std::size_t count, const RangeOptions& options) {
+	auto& jobs = JobSystem::get();
+	const std::size_t numChunks = std::max<std::size_t>(1, std::min(jobs.getNumThreads(), count / VALUE_GRAIN));
+	auto partials = makePartials(numChunks, options);
+	jobs.run("range::compute", numChunks, [&](std::size_t chunk) {
+		const std::size_t begin = (count * chunk) / numChunks;
+		const std::size_t end = (count * (chunk+1)) / numChunks;
+		accumulate(values + begin, end - begin, nullptr, partials[chunk]);
+	});
+	return finish(partials, options);
+}
+
+ValueRange compute(const std::vector< std::pair<const float*, std::size_t> >& arrays, const RangeOptions& options) {
+	auto& jobs = JobSystem::get();
+	// starts[i] is the index of the first value of array i in all values.
+	std::vector<std::size_t> starts(arrays.size() + 1, 0);
+	for(std::size_t i=0; i<arrays.size(); ++i) {
+		starts[i+1] = starts[i] + arrays[i].second;
+	}
+	const std::size_t count = starts.back();
+	const std::size_t numChunks = std::max<std::size_t>(1, std::min(jobs.getNumThreads(), count / VALUE_GRAIN));
+	auto partials = makePartials(numChunks, options);
+	jobs.run("range::compute", numChunks, [&](std::size_t chunk) {
+		const std::size_t begin = (count * chunk) / numChunks;
+		const std::size_t end = (count * (chunk+1)) / numChunks;
+		std::size_t i = std::size_t(std::upper_bound(starts.begin(), starts.end(), begin) - starts.begin()) - 1;
+		for(std::size_t position=begin; position<end; ++i) {
+			const std::size_t first = position - starts[i];
+			const std::size_t n = std::min(end, starts[i+1]) - position;
+			accumulate(arrays[i].first + first, n, nullptr, partials[chunk]);
+			position += n;
+		}
+	});
+	return finish(partials, options);
+}
+
+ValueRange flatten(const std::vector< std::vector<float> >& rows, float* dst, const RangeOptions& options) {
+	auto& jobs = JobSystem::get();
+	const std::size_t width = rows.empty() ? 0 : rows[0].size();
+	const std::size_t numChunks = std::max<std::size_t>(1, std::min(jobs.getNumThreads(), (rows.size()*width) / VALUE_GRAIN));
+	auto partials = makePartials(numChunks, options);
+	jobs.run("range::flatten", numChunks, [&](std::size_t chunk) {
+		const std::size_t begin = (rows.size() * chunk) / numChunks;
+		const std::size_t end = (rows.size() * (chunk+1)) / numChunks;
+		for(std::size_t y=begin; y<end; ++y) {
+			accumulate(rows[y].data(), std::min(width, rows[y].size()), dst + y*width, partials[chunk]);
+		}
+	});
+	return finish(partials, options);
+}
+
+}
+
+}
@@ -0,0 +1,332 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/raster.h>
+#include <mikroplot/mapped.h>
+#include <mikroplot/jobs.h>
+#include <mikroplot/texture.h>
+#include <mikroplot/GLUtils.h>
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <limits>
+#include <cstring>
+#include <cassert>
+
+namespace mikroplot {
+
+namespace {
+	const char RASTER_MAGIC[4] = {'M','P','R','S'};
+	const uint32_t RASTER_VERSION = 2;
+
+	struct RasterHeader {
+		char     magic[4];
+		uint32_t version;
+		uint64_t width;
+		uint64_t height;
+		uint64_t tileSize;
+		uint64_t numLevels;
+		uint64_t sourceSize;	// Raster file the levels were built from.
+		int64_t  sourceTime;
+	};
+
+	// Rows of level 0 read per pass of the build.
+	const std::size_t BAND_ROWS = 64;
+	const uint64_t TILE_MASK = (uint64_t(1) << 28) - 1;
+	const uint64_t NO_TILE = ~uint64_t(0);
+
+	inline float average(float a, float b, float c, float d) {
+		float sum = 0.0f;
+		int count = 0;
+		for(float value : {a, b, c, d}) {
+			if(value == value) {
+				sum += value;
+				++count;
+			}
+		}
+		return count > 0 ? sum / float(count) : std::numeric_limits<float>::quiet_NaN();
+	}
+}
+
+RasterPyramid::RasterPyramid(std::shared_ptr<ArrayFile> raster, const std::string& cacheFileName, const RasterOptions& options)
+	: m_options(options)
+	, m_raster(raster)
+	, m_cacheFileName(cacheFileName)
+	, m_left(0.0f)
+	, m_right(float(raster->getNumColumns()))
+	, m_bottom(0.0f)
+	, m_top(float(raster->getNumRows()))
+	, m_loading(NO_TILE)
+	, m_quit(false)
+	, m_frame(0)
+	, m_rangeValid(false)
+	, m_vao(0)
+	, m_vertexBuffer(0) {
+	m_options.tileSize = std::max<std::size_t>(m_options.tileSize, 1);
+	m_options.maxLoadedTiles = std::max<std::size_t>(m_options.maxLoadedTiles, 1);
+	for(std::size_t column=0; column<raster->getNumColumns(); ++column) {
+		m_columns.push_back(raster->column(column));
+	}
+	// Halve resolution until the level fits in a single tile.
+	std::size_t offset = sizeof(RasterHeader);
+	Level level{raster->getNumColumns(), raster->getNumRows(), 0, 0};
+	m_levels.push_back(level);
+	while(level.width > m_options.tileSize || level.height > m_options.tileSize) {
+		level.width = (level.width + 1) / 2;
+		level.height = (level.height + 1) / 2;
+		level.offset = offset;
+		offset += level.width*level.height*sizeof(float);
+		m_levels.push_back(level);
+	}
+	if(m_levels.size() > 255 || (raster->getNumColumns() / m_options.tileSize) > TILE_MASK || (raster->getNumRows() / m_options.tileSize) > TILE_MASK) {
+		throw std::runtime_error("Raster is too large for tile keys");
+	}
+}
+
+RasterPyramid::~RasterPyramid() {
+	stopLoader();
+	m_resident.clear();
+	if(m_vao != 0) {
+		glDeleteVertexArrays(1, &m_vao);
+		glDeleteBuffers(1, &m_vertexBuffer);
+	}
+}
+
+void RasterPyramid::build() {
+	stopLoader();
+	m_cache = 0;
+	std::ofstream f(m_cacheFileName, std::ios::binary | std::ios::trunc);
+	if(!f) {
+		throw std::runtime_error("Can not write \"" + m_cacheFileName + "\"!");
+	}
+	RasterHeader header;
+	memcpy(header.magic, RASTER_MAGIC, sizeof(header.magic));
+	header.version = RASTER_VERSION;
+	header.width = m_levels[0].width;
+	header.height = m_levels[0].height;
+	header.tileSize = m_options.tileSize;
+	header.numLevels = m_levels.size();
+	header.sourceSize = m_raster->getFileSize();
+	header.sourceTime = m_raster->getModificationTime();
+	f.write((const char*)&header, sizeof(header));
+
+	// Rows of each level are reduced to the next level as soon as they are produced. An odd row waits for its pair.
+	auto& jobs = JobSystem::get();
+	const std::size_t numLevels = m_levels.size();
+	std::vector< std::vector<float> > carry(numLevels);
+	std::vector<std::size_t> rowsWritten(numLevels, 0);
+	auto push = [&](auto& self, std::size_t level, std::vector<float>& rows, std::size_t numRows, bool last) -> void {
+		if(level+1 >= numLevels) {
+			return;
+		}
+		const Level& in = m_levels[level];
+		const Level& out = m_levels[level+1];
+		if(!carry[level].empty()) {
+			rows.insert(rows.begin(), carry[level].begin(), carry[level].end());
+			++numRows;
+			carry[level].clear();
+		}
+		const std::size_t numOut = last ? (numRows + 1) / 2 : numRows / 2;
+		if(!last && numRows % 2 == 1) {
+			carry[level].assign(rows.begin() + (numRows-1)*in.width, rows.begin() + numRows*in.width);
+		}
+		std::vector<float> result(numOut*out.width);
+		const float NaN = std::numeric_limits<float>::quiet_NaN();
+		jobs.parallelFor("RasterPyramid::build", 0, numOut, 1, [&](std::size_t begin, std::size_t end) {
+			for(std::size_t y=begin; y<end; ++y) {
+				const float* a = &rows[2*y*in.width];
+				const float* b = 2*y+1 < numRows ? &rows[(2*y+1)*in.width] : 0;
+				float* dst = &result[y*out.width];
+				for(std::size_t x=0; x<out.width; ++x) {
+					const std::size_t x1 = std::min(2*x+1, in.width-1);
+					const bool pair = x1 != 2*x;
+					dst[x] = average(a[2*x], pair ? a[x1] : NaN, b ? b[2*x] : NaN, b && pair ? b[x1] : NaN);
+				}
+			}
+		});
+		f.seekp(std::streamoff(out.offset + rowsWritten[level+1]*out.width*sizeof(float)));
+		f.write((const char*)result.data(), result.size()*sizeof(float));
+		rowsWritten[level+1] += numOut;
+		self(self, level+1, result, numOut, last);
+	};
+
+	m_raster->advise(AccessPattern::SEQUENTIAL);
+	const std::size_t width = m_levels[0].width;
+	const std::size_t height = m_levels[0].height;
+	std::vector<float> band;
+	for(std::size_t row=0; row<height; row += BAND_ROWS) {
+		const std::size_t numRows = std::min(BAND_ROWS, height - row);
+		band.resize(numRows*width);
+		jobs.parallelFor("RasterPyramid::read", 0, numRows, 1, [&](std::size_t begin, std::size_t end) {
+			for(std::size_t y=begin; y<end; ++y) {
+				for(std::size_t x=0; x<width; ++x) {
+					band[y*width + x] = m_columns[x][row + y];
+				}
+			}
+		});
+		push(push, 0, band, numRows, row + numRows == height);
+	}
+	m_raster->advise(AccessPattern::RANDOM);
+	f.close();
+	if(!f || !load()) {
+		throw std::runtime_error("Can not build raster pyramid \"" + m_cacheFileName + "\"!");
+	}
+}
+
+bool RasterPyramid::load() {
+	stopLoader();
+	m_cache = 0;
+	std::unique_ptr<MappedFile> cache;
+	try {
+		cache = std::make_unique<MappedFile>(m_cacheFileName);
+	} catch(const std::runtime_error&) {
+		return false;
+	}
+	const Level& last = m_levels.back();
+	const std::size_t size = m_levels.size() > 1 ? last.offset + last.width*last.height*sizeof(float) : sizeof(RasterHeader);
+	RasterHeader header;
+	if(cache->getSize() < size) {
+		return false;
+	}
+	memcpy(&header, cache->getData(), sizeof(header));
+	if(memcmp(header.magic, RASTER_MAGIC, sizeof(header.magic)) != 0
+		|| header.version != RASTER_VERSION
+		|| header.width != m_levels[0].width
+		|| header.height != m_levels[0].height
+		|| header.tileSize != m_options.tileSize
+		|| header.numLevels != m_levels.size()
+		|| header.sourceSize != m_raster->getFileSize()
+		|| header.sourceTime != m_raster->getModificationTime()) {
+		return false;
+	}
+	m_cache = std::move(cache);
+	m_cache->advise(AccessPattern::RANDOM);
+	for(std::size_t i=1; i<m_levels.size(); ++i) {
+		m_levels[i].values = (const float*)(m_cache->getData() + m_levels[i].offset);
+	}
+	m_quit = false;
+	m_loader = std::thread([this]() { loaderThread(); });
+	return true;
+}
+
+void RasterPyramid::loadOrBuild() {
+	if(!load()) {
+		build();
+	}
+}
+
+void RasterPyramid::setBounds(float left, float right, float bottom, float top) {
+	m_left = left;
+	m_right = right;
+	m_bottom = bottom;
+	m_top = top;
+}
+
+uint64_t RasterPyramid::tileKey(std::size_t level, std::size_t x, std::size_t y) {
+	return (uint64_t(level) << 56) | (uint64_t(y) << 28) | uint64_t(x);
+}
+
+void RasterPyramid::tileSize(uint64_t key, std::size_t& width, std::size_t& height) const {
+	const Level& level = m_levels[tileLevel(key)];
+	const std::size_t x0 = tileX(key) * m_options.tileSize;
+	const std::size_t y0 = tileY(key) * m_options.tileSize;
+	width = std::min(m_options.tileSize, level.width - x0);
+	height = std::min(m_options.tileSize, level.height - y0);
+}
+
+void RasterPyramid::readTile(uint64_t key, std::vector<float>& values) const {
+	const std::size_t levelIndex = tileLevel(key);
+	const Level& level = m_levels[levelIndex];
+	const std::size_t x0 = tileX(key) * m_options.tileSize;
+	const std::size_t y0 = tileY(key) * m_options.tileSize;
+	std::size_t width, height;
+	tileSize(key, width, height);
+	values.resize(width*height);
+	for(std::size_t y=0; y<height; ++y) {
+		if(levelIndex == 0) {
+			for(std::size_t x=0; x<width; ++x) {
+				values[y*width + x] = m_columns[x0 + x][y0 + y];
+			}
+		} else {
+			memcpy(&values[y*width], level.values + (y0 + y)*level.width + x0, width*sizeof(float));
+		}
+	}
+}
+
+void RasterPyramid::request(const std::vector<uint64_t>& keys) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_requests.clear();
+	for(auto key : keys) {
+		const bool loaded = std::any_of(m_loaded.begin(), m_loaded.end(), [&](const LoadedTile& tile) { return tile.key == key; });
+		if(!loaded && key != m_loading) {
+			m_requests.push_back(key);
+		}
+	}
+	m_condition.notify_one();
+}
+
+void RasterPyramid::collect(std::size_t maxTiles, std::vector<LoadedTile>& result) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const std::size_t count = std::min(maxTiles, m_loaded.size());
+	std::move(m_loaded.begin(), m_loaded.begin() + count, std::back_inserter(result));
+	m_loaded.erase(m_loaded.begin(), m_loaded.begin() + count);
+	m_condition.notify_one();
+}
+
+void RasterPyramid::loaderThread() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for(;;) {
+		m_condition.wait(lock, [&]() { return m_quit || (!m_requests.empty() && m_loaded.size() < m_options.maxLoadedTiles); });
+		if(m_quit) {
+			return;
+		}
+		LoadedTile tile;
+		tile.key = m_requests.front();
+		m_requests.pop_front();
+		m_loading = tile.key;
+		// Page faults of the mapped files happen here, not on the drawing thread.
+		lock.unlock();
+		readTile(tile.key, tile.values);
+		lock.lock();
+		m_loading = NO_TILE;
+		m_loaded.push_back(std::move(tile));
+	}
+}
+
+void RasterPyramid::stopLoader() {
+	if(m_loader.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit = true;
+		}
+		m_condition.notify_one();
+		m_loader.join();
+	}
+	m_requests.clear();
+	m_loaded.clear();
+}
+
+}
@@ -0,0 +1,248 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/sparse.h>
+#include <mikroplot/jobs.h>
+#include <mikroplot/texture.h>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+#include <cassert>
+#include <string.h>
+
+namespace mikroplot {
+
+namespace {
+	const float EMPTY = std::numeric_limits<float>::quiet_NaN();
+
+	// First and last pixel covered by entry at index. When zoomed out, entry goes to the pixel of its top left
+	// corner, so that each entry is counted once. When zoomed in, entry covers all pixels it overlaps.
+	inline void pixelSpan(uint64_t index, double unitsPerPixel, int64_t origin, int64_t& first, int64_t& last) {
+		first = int64_t(std::floor(double(index) / unitsPerPixel)) - origin;
+		last = unitsPerPixel < 1.0 ? int64_t(std::ceil(double(index+1) / unitsPerPixel)) - 1 - origin : first;
+	}
+
+	inline void accumulate(float& dst, float value, Aggregate mode) {
+		if(dst != dst) {
+			dst = mode == Aggregate::COUNT ? 1.0f : value;
+		} else if(mode == Aggregate::COUNT) {
+			dst += 1.0f;
+		} else if(mode == Aggregate::SUM) {
+			dst += value;
+		} else {
+			dst = std::max(dst, value);
+		}
+	}
+}
+
+SparseMatrix::SparseMatrix(std::size_t numRows, std::size_t numCols, const std::vector<uint64_t>& rowStart, const std::vector<uint32_t>& columns, const std::vector<float>& values)
+	: m_numRows(numRows)
+	, m_numCols(numCols)
+	, m_rowStart(rowStart)
+	, m_columns(columns)
+	, m_values(values) {
+	assert(m_rowStart.size() == numRows+1);
+	assert(m_rowStart.back() == m_columns.size());
+	assert(m_values.empty() || m_values.size() == m_columns.size());
+	// Sort columns of each row for binary search, if not sorted already.
+	JobSystem::get().parallelFor("SparseMatrix::sort", 0, numRows, 1024, [&](std::size_t begin, std::size_t end) {
+		std::vector<uint32_t> order;
+		std::vector<uint32_t> sortedColumns;
+		std::vector<float> sortedValues;
+		for(std::size_t row=begin; row<end; ++row) {
+			const auto first = m_columns.begin() + m_rowStart[row];
+			const auto last = m_columns.begin() + m_rowStart[row+1];
+			if(std::is_sorted(first, last)) {
+				continue;
+			}
+			if(m_values.empty()) {
+				std::sort(first, last);
+				continue;
+			}
+			order.resize(last - first);
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return first[a] < first[b]; });
+			sortedColumns.resize(order.size());
+			sortedValues.resize(order.size());
+			for(std::size_t i=0; i<order.size(); ++i) {
+				sortedColumns[i] = first[order[i]];
+				sortedValues[i] = m_values[m_rowStart[row] + order[i]];
+			}
+			std::copy(sortedColumns.begin(), sortedColumns.end(), first);
+			std::copy(sortedValues.begin(), sortedValues.end(), m_values.begin() + m_rowStart[row]);
+		}
+	});
+}
+
+SparseMatrix SparseMatrix::fromCOO(std::size_t numRows, std::size_t numCols, const std::vector<uint32_t>& rows, const std::vector<uint32_t>& columns, const std::vector<float>& values) {
+	assert(rows.size() == columns.size());
+	assert(values.empty() || values.size() == rows.size());
+	std::vector<uint64_t> rowStart(numRows+1, 0);
+	for(auto row : rows) {
+		assert(row < numRows);
+		++rowStart[row+1];
+	}
+	std::partial_sum(rowStart.begin(), rowStart.end(), rowStart.begin());
+	std::vector<uint64_t> next(rowStart.begin(), rowStart.end()-1);
+	std::vector<uint32_t> csrColumns(columns.size());
+	std::vector<float> csrValues(values.size());
+	for(std::size_t i=0; i<rows.size(); ++i) {
+		const auto index = next[rows[i]]++;
+		csrColumns[index] = columns[i];
+		if(!values.empty()) {
+			csrValues[index] = values[i];
+		}
+	}
+	return SparseMatrix(numRows, numCols, rowStart, csrColumns, csrValues);
+}
+
+void SparseMatrix::aggregate(const PixelGrid& grid, int x0, int y0, int x1, int y1, Aggregate mode, float* out) const {
+	x0 = std::max(x0, 0);
+	y0 = std::max(y0, 0);
+	x1 = std::min(x1, grid.width);
+	y1 = std::min(y1, grid.height);
+	if(x0 >= x1 || y0 >= y1) {
+		return;
+	}
+	const std::size_t width = std::size_t(grid.width);
+	// Candidate columns, exact test is done with pixelSpan.
+	const double colLow = std::floor(double(grid.x + x0) * grid.colsPerPixel) - 1.0;
+	const double colHigh = std::ceil(double(grid.x + x1) * grid.colsPerPixel) + 1.0;
+	const uint32_t colBegin = uint32_t(std::clamp(colLow, 0.0, double(m_numCols)));
+	const uint32_t colEnd = uint32_t(std::clamp(colHigh, 0.0, double(m_numCols)));
+	// Each job writes its own pixel rows.
+	JobSystem::get().parallelFor("SparseMatrix::aggregate", std::size_t(y0), std::size_t(y1), 4, [&](std::size_t begin, std::size_t end) {
+		for(std::size_t y=begin; y<end; ++y) {
+			float* dst = out + y*width;
+			std::fill(dst + x0, dst + x1, EMPTY);
+			const double rowLow = std::floor(double(grid.y + int64_t(y)) * grid.rowsPerPixel) - 1.0;
+			const double rowHigh = std::ceil(double(grid.y + int64_t(y) + 1) * grid.rowsPerPixel) + 1.0;
+			const std::size_t rowBegin = std::size_t(std::clamp(rowLow, 0.0, double(m_numRows)));
+			const std::size_t rowEnd = std::size_t(std::clamp(rowHigh, 0.0, double(m_numRows)));
+			for(std::size_t row=rowBegin; row<rowEnd; ++row) {
+				int64_t first, last;
+				pixelSpan(row, grid.rowsPerPixel, grid.y, first, last);
+				if(int64_t(y) < first || int64_t(y) > last) {
+					continue;
+				}
+				const auto rowColumns = m_columns.begin() + m_rowStart[row];
+				const auto rowColumnsEnd = m_columns.begin() + m_rowStart[row+1];
+				auto it = std::lower_bound(rowColumns, rowColumnsEnd, colBegin);
+				for(; it != rowColumnsEnd && *it < colEnd; ++it) {
+					pixelSpan(*it, grid.colsPerPixel, grid.x, first, last);
+					first = std::max<int64_t>(first, x0);
+					last = std::min<int64_t>(last, x1-1);
+					const float value = m_values.empty() ? 1.0f : m_values[std::size_t(it - m_columns.begin())];
+					for(int64_t x=first; x<=last; ++x) {
+						accumulate(dst[x], value, mode);
+					}
+				}
+			}
+		}
+	});
+}
+
+SparsePlot::SparsePlot(const SparseMatrix& matrix, Aggregate mode)
+	: m_matrix(&matrix)
+	, m_mode(mode)
+	, m_valid(false)
+	, m_uploaded(false) {
+}
+
+SparsePlot::~SparsePlot() {
+}
+
+std::size_t SparsePlot::update(float left, float right, float bottom, float top, int width, int height) {
+	if(width <= 0 || height <= 0 || !(right > left) || !(top > bottom)) {
+		m_pixels.clear();
+		m_grid = PixelGrid();
+		m_valid = false;
+		return 0;
+	}
+	// Matrix rows grow downwards: row = -y.
+	PixelGrid grid;
+	grid.colsPerPixel = (double(right) - double(left)) / width;
+	grid.rowsPerPixel = (double(top) - double(bottom)) / height;
+	grid.width = width;
+	grid.height = height;
+	// Panning changes view size by rounding errors only: keep the lattice of the previous frame.
+	auto sameScale = [](double a, double b) { return std::abs(a - b) <= 1e-6 * b; };
+	const bool sameLattice = m_valid && width == m_grid.width && height == m_grid.height
+		&& sameScale(grid.colsPerPixel, m_grid.colsPerPixel) && sameScale(grid.rowsPerPixel, m_grid.rowsPerPixel);
+	if(sameLattice) {
+		grid.colsPerPixel = m_grid.colsPerPixel;
+		grid.rowsPerPixel = m_grid.rowsPerPixel;
+	}
+	grid.x = int64_t(std::llround(double(left) / grid.colsPerPixel));
+	grid.y = int64_t(std::llround(-double(top) / grid.rowsPerPixel));
+
+	const std::size_t count = std::size_t(width) * std::size_t(height);
+	if(sameLattice) {
+		const int64_t dx = grid.x - m_grid.x;
+		const int64_t dy = grid.y - m_grid.y;
+		if(dx == 0 && dy == 0) {
+			return 0;
+		}
+		if(std::abs(dx) < width && std::abs(dy) < height) {
+			// Shift pixels still in view and aggregate only the exposed strips.
+			std::vector<float> shifted(count);
+			const int copyWidth = width - int(std::abs(dx));
+			const int srcX = dx > 0 ? int(dx) : 0;
+			const int dstX = dx > 0 ? 0 : int(-dx);
+			JobSystem::get().parallelFor("SparsePlot::shift", 0, std::size_t(height), 64, [&](std::size_t begin, std::size_t end) {
+				for(std::size_t y=begin; y<end; ++y) {
+					const int64_t srcY = int64_t(y) + dy;
+					if(srcY < 0 || srcY >= height) {
+						continue;
+					}
+					memcpy(&shifted[y*width + dstX], &m_pixels[std::size_t(srcY)*width + srcX], std::size_t(copyWidth)*sizeof(float));
+				}
+			});
+			m_pixels.swap(shifted);
+			m_grid = grid;
+			const int rowsBegin = dy > 0 ? height - int(dy) : 0;
+			const int rowsEnd = dy > 0 ? height : int(-dy);
+			const int colsBegin = dx > 0 ? width - int(dx) : 0;
+			const int colsEnd = dx > 0 ? width : int(-dx);
+			m_matrix->aggregate(grid, 0, rowsBegin, width, rowsEnd, m_mode, m_pixels.data());
+			// Column strip excluding the rows done above.
+			const int restBegin = dy > 0 ? 0 : rowsEnd;
+			const int restEnd = dy > 0 ? rowsBegin : height;
+			m_matrix->aggregate(grid, colsBegin, restBegin, colsEnd, restEnd, m_mode, m_pixels.data());
+			m_uploaded = false;
+			return std::size_t(std::abs(dy)) * width + std::size_t(std::abs(dx)) * std::size_t(restEnd - restBegin);
+		}
+	}
+	m_pixels.resize(count);
+	m_grid = grid;
+	m_matrix->aggregate(grid, 0, 0, width, height, m_mode, m_pixels.data());
+	m_valid = true;
+	m_uploaded = false;
+	return count;
+}
+
+}
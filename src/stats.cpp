@@ -0,0 +1,292 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/stats.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mikroplot {
+
+namespace {
+	const std::size_t NUM_PANES = 8;
+	const double KLL_DECAY = 2.0/3.0;
+}
+
+QuantileSketch::QuantileSketch(std::size_t k)
+	: m_k(std::max<std::size_t>(k, 8))
+	, m_count(0)
+	, m_size(0)
+	, m_coin(false)
+	, m_levels(1) {
+	updateCapacity();
+}
+
+void QuantileSketch::add(float value) {
+	if(std::isnan(value)) {
+		return;
+	}
+	m_levels[0].push_back(value);
+	++m_count;
+	++m_size;
+	compress();
+}
+
+void QuantileSketch::compress() {
+	while(m_size >= m_totalCapacity) {
+		for(std::size_t level=0; level<m_levels.size(); ++level) {
+			if(m_levels[level].size() < capacity(level)) {
+				continue;
+			}
+			if(level+1 == m_levels.size()) {
+				m_levels.emplace_back();
+				updateCapacity();
+			}
+			auto& items = m_levels[level];
+			// Promote every other item of sorted level: half of the items with double weight.
+			std::sort(items.begin(), items.end());
+			auto& next = m_levels[level+1];
+			const std::size_t offset = m_coin ? 1 : 0;
+			m_coin = !m_coin;
+			const std::size_t end = items.size() & ~std::size_t(1);
+			for(std::size_t i=offset; i<end; i += 2) {
+				next.push_back(items[i]);
+			}
+			// Odd item stays.
+			std::vector<float> rest;
+			if(items.size() % 2) {
+				rest.push_back(items.back());
+			}
+			m_size -= items.size() - rest.size() - (end / 2);
+			items.swap(rest);
+			break;
+		}
+	}
+}
+
+void QuantileSketch::updateCapacity() {
+	m_capacities.resize(m_levels.size());
+	m_totalCapacity = 0;
+	for(std::size_t level=0; level<m_levels.size(); ++level) {
+		// Top level has capacity k, lower levels decay geometrically.
+		const std::size_t depth = m_levels.size() - 1 - level;
+		m_capacities[level] = std::max<std::size_t>(2, std::size_t(std::ceil(double(m_k) * std::pow(KLL_DECAY, double(depth)))));
+		m_totalCapacity += m_capacities[level];
+	}
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+	if(other.m_levels.size() > m_levels.size()) {
+		m_levels.resize(other.m_levels.size());
+		updateCapacity();
+	}
+	for(std::size_t level=0; level<other.m_levels.size(); ++level) {
+		m_levels[level].insert(m_levels[level].end(), other.m_levels[level].begin(), other.m_levels[level].end());
+	}
+	m_count += other.m_count;
+	m_size += other.m_size;
+	compress();
+}
+
+void QuantileSketch::clear() {
+	m_levels.assign(1, std::vector<float>());
+	m_count = 0;
+	m_size = 0;
+	updateCapacity();
+}
+
+float QuantileSketch::quantile(float q) const {
+	std::vector< std::pair<float, uint64_t> > items;
+	items.reserve(m_size);
+	uint64_t totalWeight = 0;
+	for(std::size_t level=0; level<m_levels.size(); ++level) {
+		for(float value : m_levels[level]) {
+			items.push_back({value, uint64_t(1) << level});
+			totalWeight += uint64_t(1) << level;
+		}
+	}
+	if(items.empty()) {
+		return std::numeric_limits<float>::quiet_NaN();
+	}
+	std::sort(items.begin(), items.end());
+	const double rank = double(std::clamp(q, 0.0f, 1.0f)) * double(totalWeight);
+	uint64_t cumulative = 0;
+	for(const auto& item : items) {
+		cumulative += item.second;
+		if(double(cumulative) >= rank) {
+			return item.first;
+		}
+	}
+	return items.back().first;
+}
+
+StreamingStats::StreamingStats(const StatsOptions& options)
+	: m_options(options)
+	, m_numSamples(0)
+	, m_mean(0)
+	, m_m2(0)
+	, m_paneSize(std::max<std::size_t>(1, options.windowSize / NUM_PANES))
+	, m_quantileLines(options.quantiles.size()) {
+	m_options.windowSize = std::max<std::size_t>(m_options.windowSize, 1);
+	m_options.outputInterval = std::max<std::size_t>(m_options.outputInterval, 1);
+}
+
+void StreamingStats::add(float x, float value) {
+	// NaN would stay in the mean and variance even after it leaves the window. Skipped everywhere, as in QuantileSketch.
+	if(std::isnan(value)) {
+		return;
+	}
+	// Welford update with removal of the oldest sample.
+	if(m_window.size() == m_options.windowSize) {
+		const double old = m_window.front();
+		m_window.pop_front();
+		const double n = double(m_window.size());
+		if(n > 0) {
+			const double mean = m_mean;
+			m_mean = (mean * (n + 1.0) - old) / n;
+			m_m2 = std::max(0.0, m_m2 - (old - mean) * (old - m_mean));
+		} else {
+			m_mean = 0;
+			m_m2 = 0;
+		}
+	}
+	m_window.push_back(value);
+	{
+		const double n = double(m_window.size());
+		const double delta = value - m_mean;
+		m_mean += delta / n;
+		m_m2 += delta * (value - m_mean);
+	}
+
+	// Monotonic deques: front is the extreme of the window.
+	const std::size_t index = m_numSamples++;
+	const std::size_t oldest = index + 1 > m_options.windowSize ? index + 1 - m_options.windowSize : 0;
+	while(!m_minDeque.empty() && m_minDeque.back().second >= value) m_minDeque.pop_back();
+	m_minDeque.push_back({index, value});
+	while(m_minDeque.front().first < oldest) m_minDeque.pop_front();
+	while(!m_maxDeque.empty() && m_maxDeque.back().second <= value) m_maxDeque.pop_back();
+	m_maxDeque.push_back({index, value});
+	while(m_maxDeque.front().first < oldest) m_maxDeque.pop_front();
+
+	// Quantile panes.
+	if(!m_options.quantiles.empty()) {
+		if(m_panes.empty() || m_panes.back().getCount() >= m_paneSize) {
+			if(!m_panes.empty()) {
+				// Pane completed: evaluate output quantiles once per pane.
+				auto merged = mergePanes(m_panes.size());
+				m_paneQuantiles.clear();
+				for(float q : m_options.quantiles) {
+					m_paneQuantiles.push_back(merged.quantile(q));
+				}
+			}
+			m_panes.emplace_back(m_options.sketchSize);
+			if(m_panes.size() > NUM_PANES) {
+				m_panes.pop_front();
+			}
+		}
+		m_panes.back().add(value);
+	}
+
+	if(m_numSamples % m_options.outputInterval == 0) {
+		output(x);
+	}
+}
+
+void StreamingStats::add(const std::vector<vec2>& samples) {
+	for(const auto& sample : samples) {
+		add(sample.x, sample.y);
+	}
+}
+
+float StreamingStats::getVariance() const {
+	return m_window.size() > 1 ? float(m_m2 / double(m_window.size() - 1)) : 0.0f;
+}
+
+float StreamingStats::getStdDev() const {
+	return std::sqrt(getVariance());
+}
+
+float StreamingStats::getMin() const {
+	return m_minDeque.empty() ? std::numeric_limits<float>::quiet_NaN() : m_minDeque.front().second;
+}
+
+float StreamingStats::getMax() const {
+	return m_maxDeque.empty() ? std::numeric_limits<float>::quiet_NaN() : m_maxDeque.front().second;
+}
+
+float StreamingStats::getQuantile(float q) const {
+	if(m_panes.empty()) {
+		return std::numeric_limits<float>::quiet_NaN();
+	}
+	return mergePanes(m_panes.size()).quantile(q);
+}
+
+QuantileSketch StreamingStats::mergePanes(std::size_t numPanes) const {
+	QuantileSketch merged(m_options.sketchSize);
+	for(std::size_t i=0; i<numPanes; ++i) {
+		merged.merge(m_panes[i]);
+	}
+	return merged;
+}
+
+void StreamingStats::output(float x) {
+	const float mean = getMean();
+	const float stdDev = getStdDev();
+	m_meanLine.push_back(vec2(x, mean));
+	m_lowerStdLine.push_back(vec2(x, mean - stdDev));
+	m_upperStdLine.push_back(vec2(x, mean + stdDev));
+	m_minLine.push_back(vec2(x, getMin()));
+	m_maxLine.push_back(vec2(x, getMax()));
+	if(!m_options.quantiles.empty()) {
+		if(m_paneQuantiles.empty()) {
+			// First pane is still filling.
+			for(std::size_t i=0; i<m_options.quantiles.size(); ++i) {
+				m_quantileLines[i].push_back(vec2(x, m_panes.back().quantile(m_options.quantiles[i])));
+			}
+		} else {
+			for(std::size_t i=0; i<m_options.quantiles.size(); ++i) {
+				m_quantileLines[i].push_back(vec2(x, m_paneQuantiles[i]));
+			}
+		}
+	}
+
+	// Drop oldest half, when there are twice the maximum number of points: amortized O(1).
+	if(m_options.maxPoints > 0 && m_meanLine.size() >= 2*m_options.maxPoints) {
+		auto trim = [&](std::vector<vec2>& line) {
+			line.erase(line.begin(), line.end() - m_options.maxPoints);
+		};
+		trim(m_meanLine);
+		trim(m_lowerStdLine);
+		trim(m_upperStdLine);
+		trim(m_minLine);
+		trim(m_maxLine);
+		for(auto& line : m_quantileLines) {
+			trim(line);
+		}
+	}
+}
+
+}
@@ -0,0 +1,102 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/streaming.h>
+#include <mikroplot/GLUtils.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <assert.h>
+
+namespace mikroplot {
+
+StreamingSeries::StreamingSeries(std::size_t numChannels, std::size_t capacity, double sampleInterval)
+	: m_numChannels(numChannels)
+	, m_capacity(capacity)
+	, m_sampleInterval(sampleInterval)
+	, m_totalFrames(0)
+	, m_head(0)
+	, m_buffer(0)
+	, m_texture(0) {
+	assert(numChannels > 0);
+	assert(capacity > 1);
+	GLint maxTexels = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+	if(m_capacity*m_numChannels > std::size_t(maxTexels)) {
+		throw std::runtime_error("StreamingSeries capacity*numChannels " + std::to_string(m_capacity*m_numChannels)
+			+ " exceeds GL_MAX_TEXTURE_BUFFER_SIZE " + std::to_string(maxTexels) + "!");
+	}
+	glGenBuffers(1, &m_buffer);
+	checkGLError();
+	glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+	checkGLError();
+	glBufferData(GL_TEXTURE_BUFFER, m_capacity*m_numChannels*sizeof(float), 0, GL_DYNAMIC_DRAW);
+	checkGLError();
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	glGenTextures(1, &m_texture);
+	checkGLError();
+	glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+	checkGLError();
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, m_buffer);
+	checkGLError();
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+StreamingSeries::~StreamingSeries() {
+	glDeleteTextures(1, &m_texture);
+	glDeleteBuffers(1, &m_buffer);
+}
+
+void StreamingSeries::append(const float* frames, std::size_t numFrames) {
+	if(numFrames == 0) {
+		return;
+	}
+	m_totalFrames += numFrames;
+	// Frames older than capacity would be overwritten anyway.
+	if(numFrames > m_capacity) {
+		frames += (numFrames - m_capacity) * m_numChannels;
+		m_head = (m_head + numFrames - m_capacity) % m_capacity;
+		numFrames = m_capacity;
+	}
+	// At most two uploads: until the end of the ring and the wrapped part.
+	std::size_t first = std::min(numFrames, m_capacity - m_head);
+	upload(m_head, frames, first);
+	if(first < numFrames) {
+		upload(0, frames + first*m_numChannels, numFrames - first);
+	}
+	m_head = (m_head + numFrames) % m_capacity;
+}
+
+void StreamingSeries::upload(std::size_t ringIndex, const float* frames, std::size_t numFrames) {
+	glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+	checkGLError();
+	glBufferSubData(GL_TEXTURE_BUFFER, ringIndex*m_numChannels*sizeof(float), numFrames*m_numChannels*sizeof(float), frames);
+	checkGLError();
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+}
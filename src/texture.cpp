@@ -61,7 +61,11 @@ Texture::Texture(int width, int height, int nrChannels, const float* data) : m_w
 	glBindTexture(GL_TEXTURE_2D, m_textureId);
 	checkGLError();
 	// set the texture data as RGBA
-	glTexImage2D(GL_TEXTURE_2D, 0, nrChannels == 3 ? GL_RGB32F : GL_RGBA32F, width, height, 0, nrChannels == 3 ? GL_RGB : GL_RGBA, GL_FLOAT, data);
+	// Single channel textures hold raw values, for example heat maps mapped to colors in a shader.
+	static const GLenum INTERNAL_FORMATS[] = {GL_R32F, GL_RG32F, GL_RGB32F, GL_RGBA32F};
+	static const GLenum FORMATS[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+	assert(nrChannels >= 1 && nrChannels <= 4);
+	glTexImage2D(GL_TEXTURE_2D, 0, INTERNAL_FORMATS[nrChannels-1], width, height, 0, FORMATS[nrChannels-1], GL_FLOAT, data);
 	checkGLError();
 	// set the texture wrapping options to repeat
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -107,6 +111,27 @@ Texture::~Texture() {
 	checkGLError();
 }
 
+void Texture::setSubData(int x, int y, int width, int height, int nrChannels, const GLubyte* data) {
+	assert(x >= 0 && y >= 0 && x+width <= m_width && y+height <= m_height);
+	glBindTexture(GL_TEXTURE_2D, m_textureId);
+	checkGLError();
+	// Rows are tightly packed
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, nrChannels == 3 ? GL_RGB : GL_RGBA, GL_UNSIGNED_BYTE, data);
+	checkGLError();
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void Texture::setSubData(int x, int y, int width, int height, int nrChannels, const float* data) {
+	assert(x >= 0 && y >= 0 && x+width <= m_width && y+height <= m_height);
+	assert(nrChannels >= 1 && nrChannels <= 4);
+	static const GLenum FORMATS[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+	glBindTexture(GL_TEXTURE_2D, m_textureId);
+	checkGLError();
+	glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, FORMATS[nrChannels-1], GL_FLOAT, data);
+	checkGLError();
+}
+
 GLuint Texture::getTextureId() const {
 	return m_textureId;
 }
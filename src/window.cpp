@@ -33,11 +33,30 @@
 #include <stb_image_write.h>
 #include <assert.h>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <mikroplot/shader.h>
 #include <mikroplot/framebuffer.h>
 #include <mikroplot/texture.h>
 #include <mikroplot/GLUtils.h>
 #include <mikroplot/graphics.h>
+#include <mikroplot/dirtygrid.h>
+#include <mikroplot/jobs.h>
+#include <mikroplot/decimate.h>
+#include <mikroplot/pyramid.h>
+#include <mikroplot/streaming.h>
+#include <mikroplot/history.h>
+#include <mikroplot/pointindex.h>
+#include <mikroplot/quadtree.h>
+#include <mikroplot/clip.h>
+#include <mikroplot/histogram.h>
+#include <mikroplot/contour.h>
+#include <mikroplot/graph.h>
+#include <mikroplot/sparse.h>
+#include <mikroplot/amr.h>
+#include <mikroplot/raster.h>
+#include <mikroplot/feedback.h>
+#include <mikroplot/progressive.h>
 
 #define MINIAUDIO_IMPLEMENTATION
 #include <miniaudio.h>
@@ -54,6 +73,35 @@
 using namespace std;
 
 namespace mikroplot {
+	namespace {
+		// Number of rows per job, so that each job converts at least few thousands of pixels.
+		std::size_t rowGrain(std::size_t width) {
+			return std::max<std::size_t>(1, 16384 / std::max<std::size_t>(1, width));
+		}
+
+		// Converts rows of a map to tightly packed RGBA data in parallel.
+		template<typename Map, typename F>
+		std::vector<uint8_t> toRGBAData(const char* jobName, const Map& map, int& width, int& height, F toColor) {
+			height = int(map.size());
+			width = height > 0 ? int(map[0].size()) : 0;
+			std::vector<uint8_t> data(4*std::size_t(width)*std::size_t(height));
+			JobSystem::get().parallelFor(jobName, 0, map.size(), rowGrain(width), [&](std::size_t begin, std::size_t end) {
+				for(std::size_t y=begin; y<end; ++y) {
+					assert(map[y].size() == std::size_t(width));
+					uint8_t* dst = &data[4*y*width];
+					for(const auto& value : map[y]) {
+						const RGBA color = toColor(value);
+						*dst++ = color.r;
+						*dst++ = color.g;
+						*dst++ = color.b;
+						*dst++ = color.a;
+					}
+				}
+			});
+			return data;
+		}
+	}
+
 	namespace mesh {
 	void Mesh::setVBOData(int index, const std::vector<float>& data, size_t numComponents) {
 		glBindVertexArray(vao);
@@ -145,13 +193,29 @@ namespace mikroplot {
 		: m_clearColor(clearColor)
 		, m_width(sizeX)
 		, m_height(sizeY)
+		, m_framebufferWidth(0)
+		, m_framebufferHeight(0)
 		, m_palette(palette)
+		, m_paletteVersion(0)
+		, m_decimation(Decimation::NONE)
 		, m_window(0)
 		, m_left(0)
 		, m_right(0)
 		, m_bottom(0)
 		, m_top(0)
+		, m_tile({1.0f, 1.0f, 0.0f, 0.0f})
+		, m_frameLeft(0)
+		, m_frameRight(0)
+		, m_frameBottom(0)
+		, m_frameTop(0)
+		, m_pixelScale(1.0f)
 		, m_shadeFbo()
+		, m_densityFbo()
+		, m_densityPbo(0)
+		, m_densityPending(false)
+		, m_emptyVao(0)
+		, m_barBuffer(0)
+		, m_barTexture(0)
 	{
 		if(!init) init = std::make_unique<StaticInit>();
 		// Create window and check that creation was succesful.
@@ -198,10 +262,18 @@ namespace mikroplot {
 		// Create sprite and screen size quad meshes
 		m_sprite = quad::create();
 		m_ssq = quad::create();
+		// Attributeless draws need still a vertex array object.
+		glGenVertexArrays(1, &m_emptyVao);
+		checkGLError();
+		glGenBuffers(1, &m_barBuffer);
+		glGenTextures(1, &m_barTexture);
+		checkGLError();
 
 		// Query the size of the framebuffer (window content) from glfw.
 		int screenWidth, screenHeight;
 		glfwGetFramebufferSize(m_window, &screenWidth, &screenHeight);
+		m_framebufferWidth = screenWidth;
+		m_framebufferHeight = screenHeight;
 		glViewport(0, 0, screenWidth, screenHeight);
 		setScreen(0,screenWidth,0,screenHeight);
 
@@ -212,9 +284,15 @@ namespace mikroplot {
 
 	Window::~Window() {
 		m_shadeFbo = 0;
+		m_densityFbo = 0;
 		m_ssqShader = 0;
 		m_ssq = 0;
 		m_sprite = 0;
+		m_shaders.clear();
+		glDeleteVertexArrays(1, &m_emptyVao);
+		glDeleteBuffers(1, &m_barBuffer);
+		glDeleteBuffers(1, &m_densityPbo);
+		glDeleteTextures(1, &m_barTexture);
 		// Destroy window
 		glfwDestroyWindow(m_window);
 		m_window = 0;
@@ -252,6 +330,23 @@ namespace mikroplot {
 		return false;
 	}
 
+	vec2 Window::getMousePosition() const {
+		double cursorX = 0, cursorY = 0;
+		int width = 0, height = 0;
+		glfwGetCursorPos(m_window, &cursorX, &cursorY);
+		glfwGetWindowSize(m_window, &width, &height);
+		float u = width > 0 ? float(cursorX / width) : 0.0f;
+		float v = height > 0 ? float(cursorY / height) : 0.0f;
+		return vec2(m_left + u*(m_right-m_left) - m_offset[0], m_top + v*(m_bottom-m_top) - m_offset[1]);
+	}
+
+	std::ptrdiff_t Window::pick(const PointIndex& index, float maxPixels) const {
+		int width = 0, height = 0;
+		glfwGetWindowSize(m_window, &width, &height);
+		vec2 pixelsPerUnit(float(width) / std::abs(m_right-m_left), float(height) / std::abs(m_top-m_bottom));
+		return index.nearest(getMousePosition(), maxPixels, pixelsPerUnit);
+	}
+
 	int Window::getKeyPressed(int keyCode) const {
 		return keyState(m_curKeys,keyCode) && !keyState(m_prevKeys,keyCode);
 	}
@@ -269,6 +364,8 @@ namespace mikroplot {
 		drawScreenSizeQuad(m_shadeFbo->getTexture(0).get());
 		glfwSwapBuffers(m_window);
 		glFinish();
+		m_lastStats = m_stats;
+		m_stats = FrameStats();
 
 		if(m_screenshotFileName.length()>0){
 			takeScreenshot(m_screenshotFileName);
@@ -302,16 +399,152 @@ namespace mikroplot {
 		std::vector<uint8_t> lastFrame;
 		lastFrame.resize(channels*width*height);
 		glReadPixels(0,0,width,height,GL_RGBA,GL_UNSIGNED_BYTE, &lastFrame[0]);
-		for(size_t i=0; i<lastFrame.size(); ++i){
-			if((i%4) == 3){
+		// Set alpha to opaque
+		JobSystem::get().parallelFor("screenshot", 0, height, rowGrain(width), [&](std::size_t begin, std::size_t end) {
+			for(size_t i=channels*begin*width + 3; i<channels*end*width; i += channels){
 				lastFrame[i] = 0xff;
 			}
-		}
+		});
 		stbi_flip_vertically_on_write(true);
 		stbi_write_png(filename.c_str(), width, height, channels, &lastFrame[0], width*channels);
 		stbi_flip_vertically_on_write(false);
 	}
 
+	bool Window::exportPoster(const std::string& fileName, int width, int height, const std::function<void()>& drawScene, const PosterOptions& options) {
+		glfwMakeContextCurrent(m_window);
+		GLint maxSize = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+		const int samples = std::max(1, options.supersampling);
+		const int tileSize = std::max(1, std::min(options.tileSize, int(maxSize) / samples));
+		const int renderSize = tileSize*samples;
+		PngWriter png;
+		if(!png.open(fileName, width, height, 3, options.compression)) {
+			return false;
+		}
+
+		FrameBuffer fbo;
+		fbo.addColorTexture(0, std::make_shared<Texture>(renderSize, renderSize, false));
+		// shade() renders to a tile sized framebuffer too, so that it is at poster resolution.
+		auto shadeFbo = std::make_unique<FrameBuffer>();
+		shadeFbo->addColorTexture(0, std::make_shared<Texture>(renderSize, renderSize, false));
+		// Two pixel pack buffers: the previous tile is copied to the image while the GPU renders and reads back the next.
+		const std::size_t tileBytes = std::size_t(renderSize)*std::size_t(renderSize)*4;
+		GLuint pbos[2] = {0, 0};
+		glGenBuffers(2, pbos);
+		for(auto pbo : pbos) {
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+			glBufferData(GL_PIXEL_PACK_BUFFER, tileBytes, 0, GL_STREAM_READ);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		checkGLError();
+
+		GLint viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		const auto tile = m_tile;
+		const float pixelScale = m_pixelScale;
+		const int framebufferWidth = m_framebufferWidth;
+		const int framebufferHeight = m_framebufferHeight;
+		std::swap(m_shadeFbo, shadeFbo);
+		// Layers computed per framebuffer pixel are computed for each tile over its part of the view.
+		m_framebufferWidth = renderSize;
+		m_framebufferHeight = renderSize;
+		m_pixelScale = float(samples);
+		auto restore = [&]() {
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			glDeleteBuffers(2, pbos);
+			std::swap(m_shadeFbo, shadeFbo);
+			m_framebufferWidth = framebufferWidth;
+			m_framebufferHeight = framebufferHeight;
+			m_pixelScale = pixelScale;
+			m_tile = tile;
+			updateProjection();
+			glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+		};
+
+		// Tiles go from left to right and top to bottom. Each row of tiles fills a band of the image.
+		const int tilesX = (width + tileSize - 1) / tileSize;
+		const int tilesY = (height + tileSize - 1) / tileSize;
+		const int numTiles = tilesX*tilesY;
+		std::vector<uint8_t> band(std::size_t(width)*std::size_t(tileSize)*3);
+		bool ok = true;
+		// Averages samples x samples pixels of the tile read back to pbos[index % 2] into the band.
+		auto collect = [&](int index) {
+			const int x0 = (index % tilesX)*tileSize;
+			const int y0 = (index / tilesX)*tileSize;
+			const int cols = std::min(tileSize, width - x0);
+			const int rows = std::min(tileSize, height - y0);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[index % 2]);
+			const uint8_t* pixels = (const uint8_t*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+			if(pixels == 0) {
+				ok = false;
+			} else {
+				const int area = samples*samples;
+				JobSystem::get().parallelFor("exportPoster", 0, std::size_t(rows), rowGrain(std::size_t(cols)*area), [&](std::size_t begin, std::size_t end) {
+					for(std::size_t r=begin; r<end; ++r) {
+						uint8_t* dst = &band[(r*std::size_t(width) + std::size_t(x0))*3];
+						for(int c=0; c<cols; ++c) {
+							int sum[3] = {0, 0, 0};
+							for(int j=0; j<samples; ++j) {
+								// Framebuffer rows go from bottom to top.
+								const std::size_t row = std::size_t(renderSize - 1 - (int(r)*samples + j));
+								const uint8_t* src = pixels + (row*std::size_t(renderSize) + std::size_t(c*samples))*4;
+								for(int i=0; i<samples; ++i, src += 4) {
+									sum[0] += src[0];
+									sum[1] += src[1];
+									sum[2] += src[2];
+								}
+							}
+							for(int k=0; k<3; ++k) {
+								*dst++ = uint8_t((sum[k] + area/2) / area);
+							}
+						}
+					}
+				});
+				glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			}
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			if(ok && x0 + cols == width) {
+				ok = png.writeRows(band.data(), rows);
+			}
+		};
+
+		try {
+			for(int index=0; index<numTiles && ok; ++index) {
+				const float x0 = float((index % tilesX)*tileSize);
+				const float y0 = float((index / tilesX)*tileSize);
+				m_tile = {float(width)/tileSize, float(height)/tileSize, (width - 2.0f*x0)/tileSize - 1.0f, (2.0f*y0 - height)/tileSize + 1.0f};
+				updateProjection();
+				fbo.use([&]() {
+					glViewport(0, 0, renderSize, renderSize);
+					auto rgb = m_palette[m_clearColor];
+					glClearColor(rgb.r/255.0f, rgb.g/255.0f, rgb.b/255.0f, 1.0f);
+					glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
+					m_shadeFbo->use([](){
+						glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+						glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
+					});
+					drawScene();
+					drawScreenSizeQuad(m_shadeFbo->getTexture(0).get());
+					glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[index % 2]);
+					glReadPixels(0, 0, renderSize, renderSize, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+					glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+					checkGLError();
+				});
+				if(index > 0) {
+					collect(index - 1);
+				}
+			}
+			if(ok) {
+				collect(numTiles - 1);
+			}
+		} catch(...) {
+			restore();
+			throw;
+		}
+		restore();
+		return png.finish() && ok;
+	}
+
 	void Window::screenshot(const std::string filename) {
 		m_screenshotFileName = filename;
 	}
@@ -331,6 +564,7 @@ namespace mikroplot {
 		m_width = width;
 		m_height = height;
 		glfwSetWindowSize(m_window,m_width,m_height);
+		glfwGetFramebufferSize(m_window, &m_framebufferWidth, &m_framebufferHeight);
 	}
 
 	void Window::setScreenPosition(int x, int y){
@@ -365,17 +599,11 @@ namespace mikroplot {
 		if(m_left==left && m_right==right && m_bottom==bottom && m_top==top){
 			return m_projection;
 		}
-		float m_near = -1.0f;
-		float m_far = 1.0f;
 		m_left = left;
 		m_right = right;
 		m_bottom = bottom;
 		m_top = top;
 
-		glMatrixMode(GL_PROJECTION);
-		glLoadIdentity();
-		glOrtho(m_left, m_right, m_bottom, m_top, m_near, m_far);
-
 		float sx = right-left;
 		float sy = top-bottom;
 
@@ -393,6 +621,20 @@ namespace mikroplot {
 		});
 
 		quad::setPositions(*m_ssq, screenSizeQuad);
+		updateProjection();
+		return m_projection;
+	}
+
+	void Window::updateProjection() {
+		float m_near = -1.0f;
+		float m_far = 1.0f;
+
+		glMatrixMode(GL_PROJECTION);
+		glLoadIdentity();
+		// Poster tile transform is applied to normalized device coordinates after the ortho projection.
+		glTranslatef(m_tile[2], m_tile[3], 0.0f);
+		glScalef(m_tile[0], m_tile[1], 1.0f);
+		glOrtho(m_left, m_right, m_bottom, m_top, m_near, m_far);
 
 		m_projection = {
 			2.0f/(m_right-m_left),  0.0f,                       0.0f,                   0.0f,
@@ -400,30 +642,58 @@ namespace mikroplot {
 			0.0f,                   0.0f,                      -2.0f/(m_far-m_near),    0.0f,
 			0.0f,                   0.0f,                       0.0f,                   1.0f
 		};
+		m_ortho = {
+			2.0f/(m_right-m_left),  0.0f,                       0.0f,                   0.0f,
+			0.0f,                   2.0f/(m_top-m_bottom),      0.0f,                   0.0f,
+			0.0f,                   0.0f,                      -2.0f/(m_far-m_near),    0.0f,
+			-(m_right+m_left)/(m_right-m_left), -(m_top+m_bottom)/(m_top-m_bottom), -(m_far+m_near)/(m_far-m_near), 1.0f
+		};
+		m_frameProjection = m_projection;
+		// Column major: x' = scale.x*x + offset.x*w for each column, same for y.
+		for(int column=0; column<4; ++column) {
+			for(int row=0; row<2; ++row) {
+				m_projection[4*column + row] = m_tile[row]*m_projection[4*column + row] + m_tile[2 + row]*m_projection[4*column + 3];
+				m_ortho[4*column + row] = m_tile[row]*m_ortho[4*column + row] + m_tile[2 + row]*m_ortho[4*column + 3];
+			}
+		}
+		// Normalized device coordinates -1 and 1 of the tile are (-1 - offset) / scale and (1 - offset) / scale of the view.
+		auto frame = [](float low, float high, float scale, float offset, float ndc) {
+			return float(double(low) + (double(high) - double(low))*((double(ndc) - offset)/scale + 1.0)*0.5);
+		};
+		m_frameLeft = frame(m_left, m_right, m_tile[0], m_tile[2], -1.0f);
+		m_frameRight = frame(m_left, m_right, m_tile[0], m_tile[2], 1.0f);
+		m_frameBottom = frame(m_bottom, m_top, m_tile[1], m_tile[3], -1.0f);
+		m_frameTop = frame(m_bottom, m_top, m_tile[1], m_tile[3], 1.0f);
 
 		m_ssqShader->use([&](){
 			m_ssqShader->setUniform("texture0", 0);
 			m_ssqShader->setUniformm("P", &m_projection[0]);
 		});
-		return m_projection;
 	}
 
 	void Window::drawAxis(int thickColor, int thinColor, int thick, int thin) {
 		glfwMakeContextCurrent(m_window);
-		std::vector<vec2> lines;
 		int startX = (int)m_left;
 		int maxX = (int)m_right;
 		int startY = (int)m_bottom;
 		int maxY = (int)m_top;
 		// Thin lines
-		for(int x = startX; x<maxX; ++x) {
-			lines.push_back(vec2(x,startY-1));
-			lines.push_back(vec2(x,maxY+1));
-		}
-		for(int y = startY; y<maxY; ++y) {
-			lines.push_back(vec2(startX-1,y));
-			lines.push_back(vec2(maxX+1,y));
-		}
+		std::size_t numX = std::size_t(std::max(0, maxX-startX));
+		std::size_t numY = std::size_t(std::max(0, maxY-startY));
+		std::vector<vec2> lines(2*(numX+numY));
+		JobSystem::get().parallelFor("drawAxis", 0, numX+numY, 8192, [&](std::size_t begin, std::size_t end) {
+			for(std::size_t i=begin; i<end; ++i) {
+				if(i < numX) {
+					int x = startX + int(i);
+					lines[2*i+0] = vec2(x,startY-1);
+					lines[2*i+1] = vec2(x,maxY+1);
+				} else {
+					int y = startY + int(i-numX);
+					lines[2*i+0] = vec2(startX-1,y);
+					lines[2*i+1] = vec2(maxX+1,y);
+				}
+			}
+		});
 		drawLines(lines, thinColor, thin, false);
 
 		// Thick lines
@@ -437,49 +707,95 @@ namespace mikroplot {
 
 	void Window::drawPixels(const Grid& pixels) {
 		glfwMakeContextCurrent(m_window);
-		std::vector<uint8_t> mapData;
 		int mapWidth = 0;
 		int mapHeight = 0;
-		for(auto& row : pixels) {
-			++mapHeight;
-			for(auto index : row) {
-				index = index % m_palette.size();
-				assert(index >= 0 && index <m_palette.size());
-				auto& color = m_palette[index];
-				mapData.push_back(color.r);
-				mapData.push_back(color.g);
-				mapData.push_back(color.b);
-				mapData.push_back(color.a);
-				++mapWidth;
-			}
-		}
+		auto mapData = toRGBAData("drawPixels", pixels, mapWidth, mapHeight, [&](int index) {
+			index = index % m_palette.size();
+			assert(index >= 0 && index <m_palette.size());
+			return m_palette[index];
+		});
 		assert(mapWidth != 0);
 		assert(mapHeight != 0);
-		mapWidth /= mapHeight;
 
 		Texture texture(mapWidth,mapHeight,4,&mapData[0]);
+		countUpload(mapData.size());
 		drawScreenSizeQuad(&texture);
 	}
 
-	void Window::drawRGB(const RGBAMap& map) {
+	void Window::drawPixels(DirtyGrid& pixels) {
 		glfwMakeContextCurrent(m_window);
+		assert(pixels.getWidth() != 0);
+		assert(pixels.getHeight() != 0);
+		auto toRGBA = [&](const int* src, std::size_t count, uint8_t* dst) {
+			for(std::size_t i=0; i<count; ++i) {
+				auto index = src[i] % m_palette.size();
+				auto& color = m_palette[index];
+				*dst++ = color.r;
+				*dst++ = color.g;
+				*dst++ = color.b;
+				*dst++ = color.a;
+			}
+		};
+
+		int width = int(pixels.getWidth());
+		int height = int(pixels.getHeight());
 		std::vector<uint8_t> mapData;
-		int mapWidth = 0;
-		int mapHeight = 0;
-		for(auto& row : map) {
-			++mapHeight;
-			for(auto color : row) {
-				mapData.push_back(color.r);
-				mapData.push_back(color.g);
-				mapData.push_back(color.b);
-				mapData.push_back(color.a);
-				++mapWidth;
+		if(!pixels.m_texture || pixels.m_owner != this || pixels.m_paletteVersion != m_paletteVersion) {
+			// No texture yet or palette has been changed: upload everything.
+			mapData.resize(4*pixels.getWidth()*pixels.getHeight());
+			JobSystem::get().parallelFor("drawPixels", 0, pixels.getHeight(), rowGrain(pixels.getWidth()), [&](std::size_t begin, std::size_t end) {
+				toRGBA(pixels.row(begin), (end-begin)*pixels.getWidth(), &mapData[4*begin*pixels.getWidth()]);
+			});
+			pixels.m_texture = std::make_shared<Texture>(width, height, 4, &mapData[0]);
+			pixels.m_owner = this;
+			pixels.m_paletteVersion = m_paletteVersion;
+			countUpload(mapData.size());
+		} else if(pixels.isDirty()) {
+			// Upload consecutive dirty rows with overlapping spans as a single rectangle.
+			std::size_t y = pixels.m_dirtyRowBegin;
+			while(y < pixels.m_dirtyRowEnd) {
+				auto span = pixels.getDirtySpan(y);
+				if(span.begin >= span.end) {
+					++y;
+					continue;
+				}
+				std::size_t rowEnd = y+1;
+				for(; rowEnd < pixels.m_dirtyRowEnd; ++rowEnd) {
+					auto next = pixels.getDirtySpan(rowEnd);
+					if(next.begin >= next.end || next.begin >= span.end || next.end <= span.begin) {
+						break;
+					}
+					span.begin = std::min(span.begin, next.begin);
+					span.end = std::max(span.end, next.end);
+				}
+				std::size_t w = span.end - span.begin;
+				std::size_t h = rowEnd - y;
+				mapData.resize(4*w*h);
+				JobSystem::get().parallelFor("drawPixels", y, rowEnd, rowGrain(w), [&](std::size_t begin, std::size_t end) {
+					for(std::size_t row=begin; row<end; ++row) {
+						toRGBA(pixels.row(row) + span.begin, w, &mapData[4*w*(row-y)]);
+					}
+				});
+				pixels.m_texture->setSubData(int(span.begin), int(y), int(w), int(h), 4, &mapData[0]);
+				countUpload(mapData.size());
+				y = rowEnd;
 			}
 		}
+		pixels.clearDirty();
+		drawScreenSizeQuad(pixels.m_texture.get());
+	}
+
+	void Window::drawRGB(const RGBAMap& map) {
+		glfwMakeContextCurrent(m_window);
+		int mapWidth = 0;
+		int mapHeight = 0;
+		auto mapData = toRGBAData("drawRGB", map, mapWidth, mapHeight, [](const RGBA& color) {
+			return color;
+		});
 		assert(mapWidth != 0);
 		assert(mapHeight != 0);
-		mapWidth /= mapHeight;
 		Texture texture(mapWidth,mapHeight,4,&mapData[0]);
+		countUpload(mapData.size());
 		drawScreenSizeQuad(&texture);
 	}
 
@@ -487,48 +803,948 @@ namespace mikroplot {
 		glfwMakeContextCurrent(m_window);
 		assert(width*height*3 == rgb.size());
 		Texture texture(width,height,3,&rgb[0]);
+		countUpload(rgb.size());
 		drawScreenSizeQuad(&texture);
 	}
 
 
 	void Window::drawHeatMap(const HeatMap& pixels, const float valueMin, float valueMax) {
 		glfwMakeContextCurrent(m_window);
-		std::vector<uint8_t> mapData;
 		int mapWidth = 0;
 		int mapHeight = 0;
-		for(auto& row : pixels) {
-			++mapHeight;
-			for(auto heat : row) {
-				/*assert(index >= 0 && index <m_palette.size());*/
-				auto color = heatToRGB(heat, valueMin, valueMax);
-				mapData.push_back(color.r);
-				mapData.push_back(color.g);
-				mapData.push_back(color.b);
-				mapData.push_back(color.a);
-				++mapWidth;
-			}
-		}
+		auto mapData = toRGBAData("drawHeatMap", pixels, mapWidth, mapHeight, [&](float heat) {
+			return heatToRGB(heat, valueMin, valueMax);
+		});
 		assert(mapWidth != 0);
 		assert(mapHeight != 0);
-		mapWidth /= mapHeight;
 
 		Texture texture(mapWidth,mapHeight,4,&mapData[0]);
+		countUpload(mapData.size());
 		drawScreenSizeQuad(&texture);
 	}
 
+	void Window::drawContours(Contours& contours, const std::vector<int>& colors, size_t lineWidth) {
+		glfwMakeContextCurrent(m_window);
+		if(contours.getWidth() == 0 || contours.getHeight() == 0 || colors.empty()) {
+			return;
+		}
+		if(contours.m_vao == 0) {
+			glGenVertexArrays(1, &contours.m_vao);
+			glGenBuffers(1, &contours.m_vertexBuffer);
+			glBindVertexArray(contours.m_vao);
+			glBindBuffer(GL_ARRAY_BUFFER, contours.m_vertexBuffer);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(vec2), (void*)0);
+			glBindVertexArray(0);
+			checkGLError();
+		}
+		// Levels of the last update(), which may differ from getLevels() after setLevels().
+		const std::size_t numLevels = contours.m_segments.size();
+		if(contours.m_uploadedVersion != contours.m_version || contours.m_levelStart.size() != numLevels + 1) {
+			// Segments of all levels in grid units, one after another.
+			contours.m_levelStart.assign(1, 0);
+			for(std::size_t level=0; level<numLevels; ++level) {
+				contours.m_levelStart.push_back(contours.m_levelStart.back() + contours.getSegments(level).size());
+			}
+			glBindBuffer(GL_ARRAY_BUFFER, contours.m_vertexBuffer);
+			glBufferData(GL_ARRAY_BUFFER, contours.m_levelStart.back()*sizeof(vec2), 0, GL_STATIC_DRAW);
+			for(std::size_t level=0; level<numLevels; ++level) {
+				const auto& segments = contours.getSegments(level);
+				glBufferSubData(GL_ARRAY_BUFFER, contours.m_levelStart[level]*sizeof(vec2), segments.size()*sizeof(vec2), segments.data());
+			}
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			checkGLError();
+			countUpload(contours.m_levelStart.back()*sizeof(vec2));
+			contours.m_uploadedVersion = contours.m_version;
+		}
+
+		// Heat map covers the whole view with row 0 at top and values at texel centers: grid units are scaled
+		// and translated to the view by the projection, P = m_ortho * M.
+		const float sx = (m_right - m_left) / float(contours.getWidth());
+		const float sy = (m_bottom - m_top) / float(contours.getHeight());
+		const float tx = m_left + 0.5f*sx;
+		const float ty = m_top + 0.5f*sy;
+		std::vector<float> P(m_ortho.begin(), m_ortho.end());
+		for(int row=0; row<4; ++row) {
+			P[12 + row] = tx*m_ortho[row] + ty*m_ortho[4 + row] + m_ortho[12 + row];
+			P[row] = sx*m_ortho[row];
+			P[4 + row] = sy*m_ortho[4 + row];
+		}
+
+		auto& shader = getShader(shaders::positionVSSource(), shaders::colorFSSource());
+		glLineWidth(lineWidth*m_pixelScale);
+		shader.use([&]() {
+			shader.setUniformm("P", &P[0]);
+			shader.setUniform("offset", 0.0f, 0.0f);
+			glBindVertexArray(contours.m_vao);
+			for(std::size_t level=0; level<numLevels; ++level) {
+				const std::size_t first = contours.m_levelStart[level];
+				const std::size_t count = contours.m_levelStart[level+1] - first;
+				if(count == 0) {
+					continue;
+				}
+				auto rgb = m_palette[colors[level % colors.size()]];
+				shader.setUniform("color", rgb.r/255.0f, rgb.g/255.0f, rgb.b/255.0f, rgb.a/255.0f);
+				glDrawArrays(GL_LINES, GLint(first), GLsizei(count));
+			}
+			checkGLError();
+			glBindVertexArray(0);
+		});
+		m_stats.vertices += contours.m_levelStart.back();
+	}
+
+	ValueRange Window::drawHeatMap(const HeatMap& pixels, const RangeOptions& options) {
+		glfwMakeContextCurrent(m_window);
+		assert(!pixels.empty() && !pixels[0].empty());
+		const int mapWidth = int(pixels[0].size());
+		const int mapHeight = int(pixels.size());
+		// Range is computed while rows are packed for upload: no separate pass over the data.
+		std::vector<float> values(std::size_t(mapWidth)*std::size_t(mapHeight));
+		auto range = range::flatten(pixels, values.data(), options);
+
+		Texture texture(mapWidth, mapHeight, 1, values.data());
+		countUpload(values.size()*sizeof(float));
+		drawValueTexture(texture, range);
+		return range;
+	}
+
+	ValueRange Window::drawSparse(SparsePlot& plot, const RangeOptions& options) {
+		glfwMakeContextCurrent(m_window);
+		const int width = std::max(1, m_framebufferWidth);
+		const int height = std::max(1, m_framebufferHeight);
+		plot.update(std::min(m_frameLeft, m_frameRight) - m_offset[0], std::max(m_frameLeft, m_frameRight) - m_offset[0],
+			std::min(m_frameBottom, m_frameTop) - m_offset[1], std::max(m_frameBottom, m_frameTop) - m_offset[1], width, height);
+		const auto& pixels = plot.getPixels();
+		if(pixels.empty()) {
+			return ValueRange();
+		}
+		auto range = range::compute(pixels.data(), pixels.size(), options);
+		if(!plot.m_texture || plot.m_texture->getWidth() != width || plot.m_texture->getHeight() != height) {
+			plot.m_texture = std::make_shared<Texture>(width, height, 1, pixels.data());
+			countUpload(pixels.size()*sizeof(float));
+		} else if(!plot.m_uploaded) {
+			plot.m_texture->setSubData(0, 0, width, height, 1, pixels.data());
+			countUpload(pixels.size()*sizeof(float));
+		}
+		plot.m_uploaded = true;
+		drawFrameValueTexture(*plot.m_texture, range);
+		return range;
+	}
+
+	ValueRange Window::drawAmr(AmrField& field, const RangeOptions& options, float minPixels) {
+		glfwMakeContextCurrent(m_window);
+		if(field.m_patches.empty()) {
+			return ValueRange();
+		}
+		if(!field.m_packed) {
+			GLint maxSize = 0;
+			glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+			field.pack(int(maxSize));
+			field.m_textures.clear();
+		}
+		const bool changed = field.m_textures.empty() || field.m_uploadedVersion != field.m_version;
+		if(field.m_textures.empty()) {
+			// Whole atlas is uploaded only after packing.
+			auto atlas = field.atlasValues();
+			const std::size_t pageSize = std::size_t(field.m_atlasWidth)*std::size_t(field.m_atlasHeight);
+			for(int page=0; page<field.m_numPages; ++page) {
+				field.m_textures.push_back(std::make_shared<Texture>(field.m_atlasWidth, field.m_atlasHeight, 1, atlas.data() + page*pageSize));
+			}
+			countUpload(atlas.size()*sizeof(float));
+		} else if(changed) {
+			// Patches changed by setValues are uploaded to their rectangles of the atlas.
+			for(std::size_t i=0; i<field.m_patches.size(); ++i) {
+				if(field.m_dirty[i]) {
+					const auto& patch = field.m_patches[i];
+					const auto& placement = field.m_placements[i];
+					field.m_textures[placement.page]->setSubData(placement.x, placement.y, int(patch.width), int(patch.height), 1, patch.values.data());
+					countUpload(patch.values.size()*sizeof(float));
+				}
+			}
+		}
+		if(changed) {
+			std::fill(field.m_dirty.begin(), field.m_dirty.end(), 0);
+		}
+		if(changed || !(field.m_rangeOptions == options)) {
+			// Range of the patch values, read in place.
+			std::vector< std::pair<const float*, std::size_t> > values;
+			for(const auto& patch : field.m_patches) {
+				values.push_back({patch.values.data(), patch.values.size()});
+			}
+			field.m_range = range::compute(values, options);
+			field.m_rangeOptions = options;
+			field.m_uploadedVersion = field.m_version;
+		}
+
+		const float left = std::min(m_frameLeft, m_frameRight) - m_offset[0];
+		const float right = std::max(m_frameLeft, m_frameRight) - m_offset[0];
+		const float bottom = std::min(m_frameBottom, m_frameTop) - m_offset[1];
+		const float top = std::max(m_frameBottom, m_frameTop) - m_offset[1];
+		const auto visible = field.visiblePatches(left, right, bottom, top,
+			float(std::max(1, m_framebufferWidth)) / (right - left), float(std::max(1, m_framebufferHeight)) / (top - bottom), minPixels);
+		if(visible.empty()) {
+			return field.m_range;
+		}
+		// Two triangles per patch, position and atlas coordinates per vertex.
+		std::vector<float> vertices(visible.size()*24);
+		const float atlasWidth = float(field.m_atlasWidth);
+		const float atlasHeight = float(field.m_atlasHeight);
+		JobSystem::get().parallelFor("drawAmr", 0, visible.size(), 1024, [&](std::size_t begin, std::size_t end) {
+			for(std::size_t i=begin; i<end; ++i) {
+				const auto& patch = field.m_patches[visible[i]];
+				const auto& placement = field.m_placements[visible[i]];
+				const float u0 = float(placement.x) / atlasWidth;
+				const float u1 = float(placement.x + int(patch.width)) / atlasWidth;
+				const float v0 = float(placement.y) / atlasHeight;
+				const float v1 = float(placement.y + int(patch.height)) / atlasHeight;
+				const float corners[6][4] = {
+					{patch.left,  patch.top,    u0, v0},
+					{patch.left,  patch.bottom, u0, v1},
+					{patch.right, patch.bottom, u1, v1},
+					{patch.left,  patch.top,    u0, v0},
+					{patch.right, patch.bottom, u1, v1},
+					{patch.right, patch.top,    u1, v0},
+				};
+				std::copy_n(&corners[0][0], 24, &vertices[i*24]);
+			}
+		});
+		if(field.m_vao == 0) {
+			glGenVertexArrays(1, &field.m_vao);
+			glGenBuffers(1, &field.m_vertexBuffer);
+			glBindVertexArray(field.m_vao);
+			glBindBuffer(GL_ARRAY_BUFFER, field.m_vertexBuffer);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float), (void*)0);
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float), (void*)(2*sizeof(float)));
+			glBindVertexArray(0);
+			checkGLError();
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, field.m_vertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size()*sizeof(float), vertices.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		countUpload(vertices.size()*sizeof(float));
+
+		// Triangles are drawn in order: finer levels overwrite coarser ones.
+		drawValueTexture(*field.m_textures[0], field.m_range, shaders::atlasVSSource(), [&](Shader& shader) {
+			shader.setUniformm("P", &m_ortho[0]);
+			shader.setUniform("offset", m_offset[0], m_offset[1]);
+			glBindVertexArray(field.m_vao);
+			// One draw call per run of patches on the same page.
+			for(std::size_t begin=0; begin<visible.size(); ) {
+				const int page = field.m_placements[visible[begin]].page;
+				std::size_t end = begin + 1;
+				while(end < visible.size() && field.m_placements[visible[end]].page == page) {
+					++end;
+				}
+				glBindTexture(GL_TEXTURE_2D, field.m_textures[page]->getTextureId());
+				glDrawArrays(GL_TRIANGLES, GLint(6*begin), GLsizei(6*(end - begin)));
+				begin = end;
+			}
+			checkGLError();
+			glBindVertexArray(0);
+		});
+		m_stats.vertices += 6*visible.size();
+		return field.m_range;
+	}
+
+	ValueRange Window::drawRaster(RasterPyramid& raster, const RangeOptions& options) {
+		glfwMakeContextCurrent(m_window);
+		if(!raster.m_cache) {
+			return ValueRange();
+		}
+		const uint64_t frame = ++raster.m_frame;
+		const std::size_t coarsest = raster.m_levels.size() - 1;
+		if(!raster.m_rangeValid || !(raster.m_rangeOptions == options)) {
+			// Coarsest level fits in one tile and represents the whole raster.
+			std::vector<float> values;
+			raster.readTile(RasterPyramid::tileKey(coarsest, 0, 0), values);
+			raster.m_range = range::compute(values.data(), values.size(), options);
+			raster.m_rangeOptions = options;
+			raster.m_rangeValid = true;
+		}
+
+		// Level with about one value per pixel.
+		const float left = std::min(m_frameLeft, m_frameRight) - m_offset[0];
+		const float right = std::max(m_frameLeft, m_frameRight) - m_offset[0];
+		const float bottom = std::min(m_frameBottom, m_frameTop) - m_offset[1];
+		const float top = std::max(m_frameBottom, m_frameTop) - m_offset[1];
+		const double unitWidth = (double(raster.m_right) - double(raster.m_left)) / double(raster.getWidth());
+		const double unitHeight = (double(raster.m_top) - double(raster.m_bottom)) / double(raster.getHeight());
+		const double valuesPerPixel = std::min((right - left) / unitWidth / std::max(1, m_framebufferWidth),
+			(top - bottom) / unitHeight / std::max(1, m_framebufferHeight));
+		const std::size_t level = std::size_t(std::clamp(std::floor(std::log2(std::max(valuesPerPixel, 1.0))), 0.0, double(coarsest)));
+
+		// Visible tiles of the level, nearest to the center first.
+		const std::size_t tileSize = raster.m_options.tileSize;
+		const double scale = double(uint64_t(1) << level);
+		const auto& levelSize = raster.m_levels[level];
+		auto tileRange = [&](double low, double high, std::size_t size, std::size_t& first, std::size_t& last) {
+			first = std::size_t(std::clamp(std::floor(low / scale), 0.0, double(size))) / tileSize;
+			last = (std::size_t(std::clamp(std::ceil(high / scale), 0.0, double(size))) + tileSize - 1) / tileSize;
+		};
+		std::size_t tx0, tx1, ty0, ty1;
+		tileRange((left - raster.m_left) / unitWidth, (right - raster.m_left) / unitWidth, levelSize.width, tx0, tx1);
+		tileRange((raster.m_top - top) / unitHeight, (raster.m_top - bottom) / unitHeight, levelSize.height, ty0, ty1);
+		std::vector<uint64_t> wanted;
+		for(std::size_t ty=ty0; ty<ty1; ++ty) {
+			for(std::size_t tx=tx0; tx<tx1; ++tx) {
+				wanted.push_back(RasterPyramid::tileKey(level, tx, ty));
+			}
+		}
+		const double centerX = 0.5 * double(tx0 + tx1);
+		const double centerY = 0.5 * double(ty0 + ty1);
+		auto distance = [&](uint64_t key) {
+			const double dx = double(RasterPyramid::tileX(key)) + 0.5 - centerX;
+			const double dy = double(RasterPyramid::tileY(key)) + 0.5 - centerY;
+			return dx*dx + dy*dy;
+		};
+		std::sort(wanted.begin(), wanted.end(), [&](uint64_t a, uint64_t b) { return distance(a) < distance(b); });
+
+		// Coarsest tile first, so that there is always something to draw.
+		std::vector<uint64_t> missing;
+		const uint64_t root = RasterPyramid::tileKey(coarsest, 0, 0);
+		if(raster.m_resident.find(root) == raster.m_resident.end()) {
+			missing.push_back(root);
+		}
+		for(auto key : wanted) {
+			if(raster.m_resident.find(key) == raster.m_resident.end() && key != root) {
+				missing.push_back(key);
+			}
+		}
+		raster.request(missing);
+
+		std::vector<RasterPyramid::LoadedTile> loaded;
+		raster.collect(raster.m_options.maxUploadsPerFrame, loaded);
+		for(auto& tile : loaded) {
+			std::size_t width, height;
+			raster.tileSize(tile.key, width, height);
+			raster.m_resident[tile.key] = RasterPyramid::ResidentTile{std::make_shared<Texture>(int(width), int(height), 1, tile.values.data()), 0};
+			countUpload(tile.values.size()*sizeof(float));
+		}
+
+		// Resident tiles to draw: missing tiles are covered by their nearest resident ancestor, drawn first.
+		std::vector<uint64_t> fallbacks;
+		std::vector<uint64_t> tiles;
+		for(auto key : wanted) {
+			auto it = raster.m_resident.find(key);
+			if(it != raster.m_resident.end()) {
+				it->second.lastUsed = frame;
+				tiles.push_back(key);
+				continue;
+			}
+			for(std::size_t up=1; level+up <= coarsest; ++up) {
+				const uint64_t parent = RasterPyramid::tileKey(level+up, RasterPyramid::tileX(key) >> up, RasterPyramid::tileY(key) >> up);
+				auto parentIt = raster.m_resident.find(parent);
+				if(parentIt != raster.m_resident.end()) {
+					parentIt->second.lastUsed = frame;
+					fallbacks.push_back(parent);
+					break;
+				}
+			}
+		}
+		auto rootIt = raster.m_resident.find(root);
+		if(rootIt != raster.m_resident.end()) {
+			rootIt->second.lastUsed = frame;
+		}
+		std::sort(fallbacks.begin(), fallbacks.end(), std::greater<uint64_t>());
+		fallbacks.erase(std::unique(fallbacks.begin(), fallbacks.end()), fallbacks.end());
+		tiles.insert(tiles.begin(), fallbacks.begin(), fallbacks.end());
+
+		// Drop least recently used tiles, which are not drawn in this frame.
+		while(raster.m_resident.size() > raster.m_options.maxGpuTiles) {
+			auto oldest = raster.m_resident.end();
+			for(auto it = raster.m_resident.begin(); it != raster.m_resident.end(); ++it) {
+				if(it->second.lastUsed < frame && (oldest == raster.m_resident.end() || it->second.lastUsed < oldest->second.lastUsed)) {
+					oldest = it;
+				}
+			}
+			if(oldest == raster.m_resident.end()) {
+				break;
+			}
+			raster.m_resident.erase(oldest);
+		}
+		if(tiles.empty()) {
+			return raster.m_range;
+		}
+
+		std::vector<float> vertices(tiles.size()*24);
+		for(std::size_t i=0; i<tiles.size(); ++i) {
+			const uint64_t key = tiles[i];
+			const double tileScale = double(uint64_t(1) << RasterPyramid::tileLevel(key));
+			std::size_t width, height;
+			raster.tileSize(key, width, height);
+			const double x0 = double(RasterPyramid::tileX(key)) * double(tileSize) * tileScale;
+			const double y0 = double(RasterPyramid::tileY(key)) * double(tileSize) * tileScale;
+			// Last value of an odd sized level covers less than its scale.
+			const double x1 = std::min(x0 + double(width)*tileScale, double(raster.getWidth()));
+			const double y1 = std::min(y0 + double(height)*tileScale, double(raster.getHeight()));
+			const float l = float(raster.m_left + x0*unitWidth);
+			const float r = float(raster.m_left + x1*unitWidth);
+			const float t = float(raster.m_top - y0*unitHeight);
+			const float b = float(raster.m_top - y1*unitHeight);
+			const float corners[6][4] = {
+				{l, t, 0.0f, 0.0f},
+				{l, b, 0.0f, 1.0f},
+				{r, b, 1.0f, 1.0f},
+				{l, t, 0.0f, 0.0f},
+				{r, b, 1.0f, 1.0f},
+				{r, t, 1.0f, 0.0f},
+			};
+			std::copy_n(&corners[0][0], 24, &vertices[i*24]);
+		}
+		if(raster.m_vao == 0) {
+			glGenVertexArrays(1, &raster.m_vao);
+			glGenBuffers(1, &raster.m_vertexBuffer);
+			glBindVertexArray(raster.m_vao);
+			glBindBuffer(GL_ARRAY_BUFFER, raster.m_vertexBuffer);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float), (void*)0);
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float), (void*)(2*sizeof(float)));
+			glBindVertexArray(0);
+			checkGLError();
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, raster.m_vertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size()*sizeof(float), vertices.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		countUpload(vertices.size()*sizeof(float));
+
+		drawValueTexture(*raster.m_resident[tiles[0]].texture, raster.m_range, shaders::atlasVSSource(), [&](Shader& shader) {
+			shader.setUniformm("P", &m_ortho[0]);
+			shader.setUniform("offset", m_offset[0], m_offset[1]);
+			glBindVertexArray(raster.m_vao);
+			for(std::size_t i=0; i<tiles.size(); ++i) {
+				glBindTexture(GL_TEXTURE_2D, raster.m_resident[tiles[i]].texture->getTextureId());
+				glDrawArrays(GL_TRIANGLES, GLint(6*i), 6);
+			}
+			checkGLError();
+			glBindVertexArray(0);
+		});
+		m_stats.vertices += 6*tiles.size();
+		return raster.m_range;
+	}
+
+	ValueRange Window::drawDensity(const std::vector<vec2>& points, const DensityOptions& options) {
+		return drawDensity(points.size(), options, [&](float* counts) {
+			density::bin(points.data(), points.size(), std::min(m_frameLeft, m_frameRight) - m_offset[0], std::max(m_frameLeft, m_frameRight) - m_offset[0],
+				std::min(m_frameBottom, m_frameTop) - m_offset[1], std::max(m_frameBottom, m_frameTop) - m_offset[1], m_framebufferWidth, m_framebufferHeight, counts);
+		}, [&](std::size_t begin, std::size_t, std::vector<vec2>&) {
+			return points.data() + begin;
+		});
+	}
+
+	ValueRange Window::drawDensity(const ColumnView& x, const ColumnView& y, const DensityOptions& options) {
+		return drawDensity(std::min(x.size(), y.size()), options, [&](float* counts) {
+			density::bin(x, y, std::min(m_frameLeft, m_frameRight) - m_offset[0], std::max(m_frameLeft, m_frameRight) - m_offset[0],
+				std::min(m_frameBottom, m_frameTop) - m_offset[1], std::max(m_frameBottom, m_frameTop) - m_offset[1], m_framebufferWidth, m_framebufferHeight, counts);
+		}, [&](std::size_t begin, std::size_t end, std::vector<vec2>& scratch) {
+			scratch.resize(end - begin);
+			JobSystem::get().parallelFor("drawDensity", begin, end, 65536, [&](std::size_t b, std::size_t e) {
+				for(std::size_t i=b; i<e; ++i) {
+					scratch[i-begin] = vec2(x[i], y[i]);
+				}
+			});
+			return (const vec2*)scratch.data();
+		});
+	}
+
+	ValueRange Window::drawDensity(std::size_t count, const DensityOptions& options, const std::function<void(float*)>& bin,
+								   const std::function<const vec2*(std::size_t, std::size_t, std::vector<vec2>&)>& chunk) {
+		glfwMakeContextCurrent(m_window);
+		const int width = std::max(1, m_framebufferWidth);
+		const int height = std::max(1, m_framebufferHeight);
+		std::vector<float> counts(std::size_t(width)*std::size_t(height), 0.0f);
+		std::shared_ptr<Texture> texture;
+		if(options.useGPU) {
+			if(!m_densityFbo || m_densityFbo->getTexture(0)->getWidth() != width || m_densityFbo->getTexture(0)->getHeight() != height) {
+				m_densityFbo = std::make_unique<FrameBuffer>();
+				m_densityFbo->addColorTexture(0, std::make_shared<Texture>(width, height, 1, counts.data()));
+				if(!m_densityPbo) {
+					glGenBuffers(1, &m_densityPbo);
+				}
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, m_densityPbo);
+				glBufferData(GL_PIXEL_PACK_BUFFER, counts.size()*sizeof(float), 0, GL_STREAM_READ);
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+				m_densityPending = false;
+			}
+			// The range is computed from the counts of the previous frame, which are read back by now, so that the
+			// pipeline does not stall waiting for this frame to be drawn. Only the first frame of each size waits.
+			// Poster tiles are read back synchronously: the previous counts are of another tile.
+			const bool tiled = m_tile != std::array<float,4>{1.0f, 1.0f, 0.0f, 0.0f};
+			const bool previous = m_densityPending && !tiled;
+			if(previous) {
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, m_densityPbo);
+				const float* data = (const float*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+				if(data) {
+					std::copy(data, data + counts.size(), counts.begin());
+					glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+				}
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+				checkGLError();
+			}
+			unsigned int vao = 0;
+			unsigned int vbo = 0;
+			glGenVertexArrays(1, &vao);
+			glGenBuffers(1, &vbo);
+			glBindVertexArray(vao);
+			glBindBuffer(GL_ARRAY_BUFFER, vbo);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(vec2), (void*)0);
+			checkGLError();
+
+			// Row 0 of the counts is the top of the screen, as in textures drawn with the screen size quad.
+			auto P = m_ortho;
+			for(int i=1; i<16; i+=4) {
+				P[i] = -P[i];
+			}
+			GLint viewport[4];
+			glGetIntegerv(GL_VIEWPORT, viewport);
+			glDisable(GL_POINT_SMOOTH);
+			glPointSize(1.0f);
+			glBlendFunc(GL_ONE, GL_ONE);
+			auto& shader = getShader(shaders::positionVSSource(), shaders::colorFSSource());
+			std::vector<vec2> scratch;
+			m_densityFbo->use([&]() {
+				glViewport(0, 0, width, height);
+				glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+				glClear(GL_COLOR_BUFFER_BIT);
+				shader.use([&]() {
+					shader.setUniformm("P", &P[0]);
+					shader.setUniform("offset", m_offset[0], m_offset[1]);
+					shader.setUniform("color", 1.0f, 0.0f, 0.0f, 0.0f);
+					for(std::size_t begin=0; begin<count; begin += options.chunkSize) {
+						const std::size_t end = std::min(count, begin + options.chunkSize);
+						const vec2* points = chunk(begin, end, scratch);
+						// Orphan the previous chunk instead of waiting for it to be drawn.
+						glBufferData(GL_ARRAY_BUFFER, (end-begin)*sizeof(vec2), points, GL_STREAM_DRAW);
+						countUpload((end-begin)*sizeof(vec2));
+						glDrawArrays(GL_POINTS, 0, GLsizei(end-begin));
+						checkGLError();
+					}
+				});
+				// Counts are needed for the range only: the texture stays on the GPU.
+				if(!previous) {
+					glReadPixels(0, 0, width, height, GL_RED, GL_FLOAT, counts.data());
+				}
+				if(!tiled) {
+					glBindBuffer(GL_PIXEL_PACK_BUFFER, m_densityPbo);
+					glReadPixels(0, 0, width, height, GL_RED, GL_FLOAT, 0);
+					glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+				}
+				m_densityPending = !tiled;
+				checkGLError();
+			});
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			glEnable(GL_POINT_SMOOTH);
+			glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			glBindVertexArray(0);
+			glDeleteBuffers(1, &vbo);
+			glDeleteVertexArrays(1, &vao);
+			texture = m_densityFbo->getTexture(0);
+			m_stats.vertices += count;
+		} else {
+			bin(counts.data());
+			texture = std::make_shared<Texture>(width, height, 1, counts.data());
+			countUpload(counts.size()*sizeof(float));
+		}
+
+		// Empty pixels are not part of the range.
+		JobSystem::get().parallelFor("drawDensity", 0, counts.size(), 65536, [&](std::size_t begin, std::size_t end) {
+			for(std::size_t i=begin; i<end; ++i) {
+				if(counts[i] == 0.0f) {
+					counts[i] = std::numeric_limits<float>::quiet_NaN();
+				}
+			}
+		});
+		RangeOptions rangeOptions;
+		rangeOptions.mode = options.scale == DensityScale::EQUALIZE ? AutoRange::EQUALIZE : AutoRange::MIN_MAX;
+		auto range = range::compute(counts.data(), counts.size(), rangeOptions);
+		drawFrameValueTexture(*texture, range, options.scale == DensityScale::LOG, true);
+		return range;
+	}
+
+	void Window::drawValueTexture(const Texture& texture, const ValueRange& range, bool logScale, bool skipZero) {
+		drawValueTexture(texture, range, shaders::projectionVSSource(), [&](Shader& shader) {
+			shader.setUniformm("P", &m_projection[0]);
+			quad::render(*m_ssq);
+		}, logScale, skipZero);
+	}
+
+	void Window::drawFrameValueTexture(const Texture& texture, const ValueRange& range, bool logScale, bool skipZero) {
+		drawValueTexture(texture, range, shaders::projectionVSSource(), [&](Shader& shader) {
+			shader.setUniformm("P", &m_frameProjection[0]);
+			quad::render(*m_ssq);
+		}, logScale, skipZero);
+	}
+
+	void Window::drawValueTexture(const Texture& texture, const ValueRange& range, const std::string& vertexShader, const std::function<void(Shader&)>& draw, bool logScale, bool skipZero) {
+		std::unique_ptr<Texture> lut;
+		if(!range.lut.empty()) {
+			lut = std::make_unique<Texture>(int(range.lut.size()), 1, 1, range.lut.data());
+			countUpload(range.lut.size()*sizeof(float));
+		}
+
+		auto& shader = getShader(vertexShader, shaders::heatMapFSSource());
+		shader.use([&]() {
+			shader.setUniform("texture0", 0);
+			shader.setUniform("lut", 1);
+			shader.setUniform("valueMin", logScale ? std::log1p(std::max(range.min, 0.0f)) : range.min);
+			shader.setUniform("valueMax", logScale ? std::log1p(std::max(range.max, 0.0f)) : range.max);
+			shader.setUniform("equalize", lut ? 1 : 0);
+			shader.setUniform("lutSize", float(range.lut.size()));
+			shader.setUniform("logScale", logScale ? 1 : 0);
+			shader.setUniform("skipZero", skipZero ? 1 : 0);
+			if(lut) {
+				glActiveTexture(GL_TEXTURE1);
+				glBindTexture(GL_TEXTURE_2D, lut->getTextureId());
+			}
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, texture.getTextureId());
+			draw(shader);
+		});
+	}
+
 	void Window::drawLines(const std::vector<vec2>& lines, int color, size_t lineWidth, bool drawStrips) {
+		// Decimate only when there are clearly more points than pixel columns.
+		const std::size_t columns = std::size_t(std::max(1, m_framebufferWidth));
+		if(drawStrips && m_decimation != Decimation::NONE && lines.size() > 4*columns) {
+			std::vector<vec2> decimated;
+			if(m_decimation == Decimation::M4) {
+				decimated = decimate::m4(lines.data(), lines.size(), std::min(m_frameLeft, m_frameRight) - m_offset[0], std::max(m_frameLeft, m_frameRight) - m_offset[0], columns);
+			} else {
+				decimated = decimate::lttb(lines.data(), lines.size(), std::min(m_frameLeft, m_frameRight) - m_offset[0], std::max(m_frameLeft, m_frameRight) - m_offset[0], 2*columns);
+			}
+			drawLines(decimated.data(), decimated.size(), color, lineWidth, drawStrips);
+			return;
+		}
+		drawLines(lines.data(), lines.size(), color, lineWidth, drawStrips);
+	}
+
+	void Window::drawLines(const ColumnView& x, const ColumnView& y, int color, size_t lineWidth) {
+		const std::size_t count = std::min(x.size(), y.size());
+		const std::size_t columns = std::size_t(std::max(1, m_framebufferWidth));
+		if(m_decimation != Decimation::NONE && count > 4*columns) {
+			std::vector<vec2> decimated;
+			if(m_decimation == Decimation::M4) {
+				decimated = decimate::m4(x, y, std::min(m_frameLeft, m_frameRight) - m_offset[0], std::max(m_frameLeft, m_frameRight) - m_offset[0], columns);
+			} else {
+				decimated = decimate::lttb(x, y, std::min(m_frameLeft, m_frameRight) - m_offset[0], std::max(m_frameLeft, m_frameRight) - m_offset[0], 2*columns);
+			}
+			drawLines(decimated.data(), decimated.size(), color, lineWidth, true);
+			return;
+		}
+		glfwMakeContextCurrent(m_window);
+		glMatrixMode(GL_MODELVIEW);
+		glLoadIdentity();
+		glLineWidth(lineWidth*m_pixelScale);
+		auto rgb = m_palette[color];
+		glColor4f(rgb.r/255.0f,rgb.g/255.0f,rgb.b/255.0f,rgb.a/255.0f);
+		glBegin(GL_LINE_STRIP);
+		for(size_t i=0; i<count; ++i){
+		   glVertex2f(x[i]+m_offset[0], y[i]+m_offset[1]);
+		}
+		glEnd();
+		m_stats.vertices += count;
+	}
+
+	void Window::drawPoints(const ColumnView& x, const ColumnView& y, int color, size_t pointSize) {
+		glfwMakeContextCurrent(m_window);
+		const std::size_t count = std::min(x.size(), y.size());
+		glMatrixMode(GL_MODELVIEW);
+		glLoadIdentity();
+		glPointSize(pointSize*m_pixelScale);
+		auto rgb = m_palette[color];
+		glColor4f(rgb.r/255.0f,rgb.g/255.0f,rgb.b/255.0f,rgb.a/255.0f);
+		glBegin(GL_POINTS);
+		for(size_t i=0; i<count; ++i){
+		   glVertex2f(x[i]+m_offset[0], y[i]+m_offset[1]);
+		}
+		glEnd();
+		m_stats.vertices += count;
+	}
+
+	void Window::drawLines(const vec2* lines, std::size_t count, int color, size_t lineWidth, bool drawStrips) {
+		glfwMakeContextCurrent(m_window);
+		glMatrixMode(GL_MODELVIEW);
+		glLoadIdentity();
+		glLineWidth(lineWidth*m_pixelScale);
+		auto rgb = m_palette[color];
+		glColor4f(rgb.r/255.0f,rgb.g/255.0f,rgb.b/255.0f,rgb.a/255.0f);
+
+		for(const auto& run : visibleRuns(lines, count, drawStrips ? clip::Primitive::LINE_STRIP : clip::Primitive::LINES, lineWidth)) {
+			glBegin(drawStrips ? GL_LINE_STRIP : GL_LINES);
+			for(size_t i=run.first; i<run.second; ++i){
+			   glVertex2f(lines[i].x+m_offset[0], lines[i].y+m_offset[1]);
+			}
+			glEnd();
+			m_stats.vertices += run.second - run.first;
+		}
+	}
+
+	void Window::drawPoints(const vec2* points, std::size_t count, int color, size_t pointSize) {
 		glfwMakeContextCurrent(m_window);
 		glMatrixMode(GL_MODELVIEW);
 		glLoadIdentity();
-		glLineWidth(lineWidth);
+		glPointSize(pointSize*m_pixelScale);
 		auto rgb = m_palette[color];
 		glColor4f(rgb.r/255.0f,rgb.g/255.0f,rgb.b/255.0f,rgb.a/255.0f);
 
-		glBegin(drawStrips ? GL_LINE_STRIP : GL_LINES);
-		for(size_t i=0; i<lines.size(); ++i){
-		   glVertex2f(lines[i].x+m_offset[0], lines[i].y+m_offset[1]);
+		glBegin(GL_POINTS);
+		for(const auto& run : visibleRuns(points, count, clip::Primitive::POINTS, pointSize)) {
+			for(size_t i=run.first; i<run.second; ++i){
+			   glVertex2f(points[i].x+m_offset[0], points[i].y+m_offset[1]);
+			}
+			m_stats.vertices += run.second - run.first;
+		}
+		glEnd();
+	}
+
+	void Window::drawHistogram(const Histogram& histogram, int color, bool density, float barWidth) {
+		glfwMakeContextCurrent(m_window);
+		const std::size_t numBins = histogram.getNumBins();
+		// Density is normalized by the values inside the bins, so that the plotted bars integrate to 1.
+		const uint64_t inRange = histogram.getTotal() - histogram.getUnderflow() - histogram.getOverflow();
+		const double scale = density && inRange > 0 ? 1.0 / (double(inRange) * histogram.getBinWidth()) : 1.0;
+		std::vector<float> heights(numBins);
+		for(std::size_t bin=0; bin<numBins; ++bin) {
+			heights[bin] = float(double(histogram.getCount(bin)) * scale);
+		}
+		glBindBuffer(GL_TEXTURE_BUFFER, m_barBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, heights.size()*sizeof(float), heights.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		countUpload(heights.size()*sizeof(float));
+
+		auto& shader = getShader(shaders::barsVSSource(), shaders::colorFSSource());
+		shader.use([&]() {
+			auto rgb = m_palette[color];
+			shader.setUniformm("P", &m_ortho[0]);
+			shader.setUniform("offset", m_offset[0], m_offset[1]);
+			shader.setUniform("heights", 0);
+			shader.setUniform("x0", histogram.getMin());
+			shader.setUniform("binWidth", histogram.getBinWidth());
+			shader.setUniform("barWidth", barWidth);
+			shader.setUniform("color", rgb.r/255.0f, rgb.g/255.0f, rgb.b/255.0f, rgb.a/255.0f);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_BUFFER, m_barTexture);
+			glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, m_barBuffer);
+			glBindVertexArray(m_emptyVao);
+			glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(numBins));
+			checkGLError();
+			glBindVertexArray(0);
+			glBindTexture(GL_TEXTURE_BUFFER, 0);
+		});
+		m_stats.vertices += 4*numBins;
+	}
+
+	void Window::binHistogram(Histogram& histogram, const float* values, std::size_t count) {
+		glfwMakeContextCurrent(m_window);
+		// Float counts are exact up to 2^24, so each pass bins at most 2^24 values.
+		const std::size_t CHUNK_SIZE = std::size_t(1) << 24;
+		const int MAX_WIDTH = 4096;
+		const int numSlots = int(histogram.m_counts.size());
+		const int width = std::min(numSlots, MAX_WIDTH);
+		const int height = (numSlots + width - 1) / width;
+
+		std::vector<float> zeros(std::size_t(width)*std::size_t(height), 0.0f);
+		FrameBuffer fbo;
+		fbo.addColorTexture(0, std::make_shared<Texture>(width, height, 1, zeros.data()));
+		unsigned int vao = 0;
+		unsigned int vbo = 0;
+		glGenVertexArrays(1, &vao);
+		glGenBuffers(1, &vbo);
+		glBindVertexArray(vao);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+		checkGLError();
+
+		GLint viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		glDisable(GL_POINT_SMOOTH);
+		glPointSize(1.0f);
+		glBlendFunc(GL_ONE, GL_ONE);
+		auto& shader = getShader(shaders::histogramBinVSSource(), shaders::colorFSSource());
+		std::vector<float> slots(zeros.size());
+		for(std::size_t begin=0; begin<count; begin += CHUNK_SIZE) {
+			const std::size_t n = std::min(CHUNK_SIZE, count - begin);
+			glBufferData(GL_ARRAY_BUFFER, n*sizeof(float), values + begin, GL_STREAM_DRAW);
+			countUpload(n*sizeof(float));
+			fbo.use([&]() {
+				glViewport(0, 0, width, height);
+				glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+				glClear(GL_COLOR_BUFFER_BIT);
+				shader.use([&]() {
+					shader.setUniform("minValue", histogram.getMin());
+					shader.setUniform("maxValue", histogram.getMax());
+					shader.setUniform("numBins", int(histogram.getNumBins()));
+					shader.setUniform("width", width);
+					shader.setUniform("height", height);
+					shader.setUniform("color", 1.0f, 0.0f, 0.0f, 0.0f);
+					glDrawArrays(GL_POINTS, 0, GLsizei(n));
+					checkGLError();
+				});
+				glReadPixels(0, 0, width, height, GL_RED, GL_FLOAT, slots.data());
+				checkGLError();
+			});
+			for(int slot=0; slot<numSlots; ++slot) {
+				const uint64_t n = uint64_t(slots[slot] + 0.5f);
+				histogram.m_counts[slot] += n;
+				histogram.m_total += n;
+			}
+		}
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glEnable(GL_POINT_SMOOTH);
+		glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindVertexArray(0);
+		glDeleteBuffers(1, &vbo);
+		glDeleteVertexArrays(1, &vao);
+	}
+
+	void Window::drawGraph(GraphLayout& graph, int nodeColor, int edgeColor, size_t pointSize, size_t lineWidth) {
+		glfwMakeContextCurrent(m_window);
+		if(graph.getNumNodes() == 0) {
+			return;
+		}
+		if(graph.m_vao == 0) {
+			// Edge indices are static: upload once.
+			glGenVertexArrays(1, &graph.m_vao);
+			glGenBuffers(1, &graph.m_positionBuffer);
+			glGenBuffers(1, &graph.m_indexBuffer);
+			glBindVertexArray(graph.m_vao);
+			glBindBuffer(GL_ARRAY_BUFFER, graph.m_positionBuffer);
+			glBufferData(GL_ARRAY_BUFFER, graph.getNumNodes()*sizeof(vec2), 0, GL_DYNAMIC_DRAW);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(vec2), (void*)0);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, graph.m_indexBuffer);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, graph.getEdges().size()*2*sizeof(uint32_t), graph.getEdges().data(), GL_STATIC_DRAW);
+			glBindVertexArray(0);
+			checkGLError();
+			countUpload(graph.getEdges().size()*2*sizeof(uint32_t));
+		}
+		if(graph.m_uploadedVersion != graph.m_version) {
+			glBindBuffer(GL_ARRAY_BUFFER, graph.m_positionBuffer);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, graph.getNumNodes()*sizeof(vec2), graph.getPositions().data());
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			graph.m_uploadedVersion = graph.m_version;
+			countUpload(graph.getNumNodes()*sizeof(vec2));
+		}
+
+		auto& shader = getShader(shaders::positionVSSource(), shaders::colorFSSource());
+		shader.use([&]() {
+			shader.setUniformm("P", &m_ortho[0]);
+			shader.setUniform("offset", m_offset[0], m_offset[1]);
+			glBindVertexArray(graph.m_vao);
+			auto rgb = m_palette[edgeColor];
+			shader.setUniform("color", rgb.r/255.0f, rgb.g/255.0f, rgb.b/255.0f, rgb.a/255.0f);
+			glLineWidth(lineWidth*m_pixelScale);
+			glDrawElements(GL_LINES, GLsizei(2*graph.getEdges().size()), GL_UNSIGNED_INT, (void*)0);
+			rgb = m_palette[nodeColor];
+			shader.setUniform("color", rgb.r/255.0f, rgb.g/255.0f, rgb.b/255.0f, rgb.a/255.0f);
+			glPointSize(pointSize*m_pixelScale);
+			glDrawArrays(GL_POINTS, 0, GLsizei(graph.getNumNodes()));
+			checkGLError();
+			glBindVertexArray(0);
+		});
+		m_stats.vertices += 2*graph.getEdges().size() + graph.getNumNodes();
+	}
+
+	void Window::drawBand(const std::vector<vec2>& lower, const std::vector<vec2>& upper, int color, float opacity) {
+		glfwMakeContextCurrent(m_window);
+		const std::size_t count = std::min(lower.size(), upper.size());
+		glMatrixMode(GL_MODELVIEW);
+		glLoadIdentity();
+		auto rgb = m_palette[color];
+		glColor4f(rgb.r/255.0f,rgb.g/255.0f,rgb.b/255.0f,opacity*rgb.a/255.0f);
+		glBegin(GL_TRIANGLE_STRIP);
+		for(size_t i=0; i<count; ++i){
+		   glVertex2f(lower[i].x+m_offset[0], lower[i].y+m_offset[1]);
+		   glVertex2f(upper[i].x+m_offset[0], upper[i].y+m_offset[1]);
 		}
 		glEnd();
+		m_stats.vertices += 2*count;
+	}
+
+	std::vector< std::pair<std::size_t, std::size_t> > Window::visibleRuns(const vec2* points, std::size_t count, clip::Primitive primitive, std::size_t marginPx) const {
+		// Clipping costs more than it saves for short arrays.
+		const std::size_t CLIP_MIN_POINTS = 4096;
+		if(count < CLIP_MIN_POINTS) {
+			return {{0, count}};
+		}
+		const float marginX = float(marginPx) * std::abs(m_frameRight - m_frameLeft) / float(std::max(1, m_framebufferWidth));
+		const float marginY = float(marginPx) * std::abs(m_frameTop - m_frameBottom) / float(std::max(1, m_framebufferHeight));
+		return clip::visibleRuns(points, count, primitive,
+			std::min(m_frameLeft, m_frameRight) - m_offset[0] - marginX, std::max(m_frameLeft, m_frameRight) - m_offset[0] + marginX,
+			std::min(m_frameBottom, m_frameTop) - m_offset[1] - marginY, std::max(m_frameBottom, m_frameTop) - m_offset[1] + marginY);
+	}
+
+	void Window::drawPoints(const PointQuadtree& points, int color, size_t pointSize, float pointsPerPixel) {
+		auto visible = points.query(m_frameLeft - m_offset[0], m_frameRight - m_offset[0], m_frameBottom - m_offset[1], m_frameTop - m_offset[1], m_framebufferWidth, m_framebufferHeight, pointsPerPixel);
+		drawPoints(visible.data(), visible.size(), color, pointSize);
+	}
+
+	void Window::drawSeries(const SeriesPyramid& series, int color, size_t lineWidth) {
+		auto points = series.query(std::min(m_frameLeft, m_frameRight) - m_offset[0], std::max(m_frameLeft, m_frameRight) - m_offset[0], std::size_t(std::max(1, m_framebufferWidth)));
+		drawLines(points.data(), points.size(), color, lineWidth, true);
+	}
+
+	void Window::drawHistory(const SeriesHistory& history, int color, size_t lineWidth) {
+		drawLines(history.query(std::min(m_frameLeft, m_frameRight) - m_offset[0], std::max(m_frameLeft, m_frameRight) - m_offset[0]), color, lineWidth, true);
+	}
+
+	void Window::drawStreamingSeries(const StreamingSeries& series, std::size_t channel, int color, size_t lineWidth) {
+		glfwMakeContextCurrent(m_window);
+		assert(channel < series.getNumChannels());
+		const std::size_t size = series.getSize();
+		if(size < 2) {
+			return;
+		}
+		// Visible frames [f0,f1], clamped to frames in the buffer.
+		const double dx = series.getSampleInterval();
+		const double total = double(series.getTotalFrames());
+		const double oldest = total - double(size);
+		const double left = std::min(m_left, m_right) - m_offset[0];
+		const double right = std::max(m_left, m_right) - m_offset[0];
+		const double f0 = std::max(oldest, std::floor(left / dx) - 1.0);
+		const double f1 = std::min(total - 1.0, std::ceil(right / dx) + 1.0);
+		if(f1 <= f0) {
+			return;
+		}
+		const std::size_t count = std::size_t(f1 - f0) + 1;
+		const std::size_t age = std::size_t(total - f0);	// 1 ... capacity
+		const std::size_t first = (series.m_head + series.getCapacity() - age) % series.getCapacity();
+
+		// Absolute x of late frames does not fit float precision: the shader computes x relative to the left edge of
+		// the view, and the translation of the projection is computed for the edge in double precision.
+		const double origin = std::min(m_left, m_right);
+		std::vector<float> P(m_ortho.begin(), m_ortho.end());
+		P[12] = float(m_tile[0]*(2.0*origin - double(m_left) - double(m_right)) / (double(m_right) - double(m_left)) + m_tile[2]);
+
+		auto& shader = getShader(shaders::streamingVSSource(), shaders::colorFSSource());
+		glLineWidth(lineWidth*m_pixelScale);
+		shader.use([&]() {
+			auto rgb = m_palette[color];
+			shader.setUniformm("P", &P[0]);
+			shader.setUniform("offset", 0.0f, m_offset[1]);
+			shader.setUniform("samples", 0);
+			shader.setUniform("capacity", int(series.getCapacity()));
+			shader.setUniform("numChannels", int(series.getNumChannels()));
+			shader.setUniform("channel", int(channel));
+			shader.setUniform("first", int(first));
+			shader.setUniform("firstX", float(f0*dx + double(m_offset[0]) - origin));
+			shader.setUniform("dx", float(dx));
+			shader.setUniform("color", rgb.r/255.0f, rgb.g/255.0f, rgb.b/255.0f, rgb.a/255.0f);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_BUFFER, series.m_texture);
+			glBindVertexArray(m_emptyVao);
+			glDrawArrays(GL_LINE_STRIP, 0, GLsizei(count));
+			checkGLError();
+			glBindVertexArray(0);
+			glBindTexture(GL_TEXTURE_BUFFER, 0);
+		});
+		m_stats.vertices += count;
 	}
 
 	void Window::drawSprite(const std::vector< std::vector<float> >& transform, const Grid& pixels, const std::string& surfaceShader, const std::string& globals){
@@ -537,33 +1753,21 @@ namespace mikroplot {
 
 	void Window::drawSprite(const std::vector< std::vector<float> >& transform, const Grid& pixels, const std::vector<Constant>& inputConstants, const std::string& surfaceShader, const std::string& globals){
 		glfwMakeContextCurrent(m_window);
-		std::vector<uint8_t> mapData;
 		int mapWidth = 0;
 		int mapHeight = 0;
-		for(auto& row : pixels) {
-			++mapHeight;
-			for(auto index : row) {
-				assert(index >= 0 && index <m_palette.size());
-				auto& color = m_palette[index];
-				mapData.push_back(color.r);
-				mapData.push_back(color.g);
-				mapData.push_back(color.b);
-				mapData.push_back(color.a);
-				++mapWidth;
-			}
-		}
+		auto mapData = toRGBAData("drawSprite", pixels, mapWidth, mapHeight, [&](int index) {
+			assert(index >= 0 && index <m_palette.size());
+			return m_palette[index];
+		});
 		if(pixels.size()==0){
-			mapWidth = ++mapHeight = 1;
-			mapData.push_back(0xff);
-			mapData.push_back(0xff);
-			mapData.push_back(0xff);
-			mapData.push_back(0xff);
+			mapWidth = mapHeight = 1;
+			mapData = {0xff, 0xff, 0xff, 0xff};
 		}
 		assert(mapWidth != 0);
 		assert(mapHeight != 0);
-		mapWidth /= mapHeight;
 
 		Texture texture(mapWidth,mapHeight,4,&mapData[0]);
+		countUpload(mapData.size());
 
 		std::vector<float> matModel;
 		for(size_t y=0; y<transform.size(); ++y){
@@ -587,38 +1791,53 @@ namespace mikroplot {
 
 	void Window::drawFunction(const std::function<float (float)> &f, int color, size_t lineWidth){
 		glfwMakeContextCurrent(m_window);
-		int width, height;
-		glfwGetFramebufferSize(m_window, &width, &height);
+		int width = m_framebufferWidth;
 		glMatrixMode(GL_MODELVIEW);
 		glLoadIdentity();
-		glLineWidth(lineWidth);
+		glLineWidth(lineWidth*m_pixelScale);
 		auto rgb = m_palette[color];
 		glColor4f(rgb.r/255.0f,rgb.g/255.0f,rgb.b/255.0f,rgb.a/255.0f);
 
 		glBegin(GL_LINE_STRIP);
-		float dX = (m_right-m_left)/float(width);
+		float dX = (m_frameRight-m_frameLeft)/float(width);
 		for(size_t i=0; i<width; i+=4) {
-			float x = m_left + (i*dX);
+			float x = m_frameLeft + (i*dX);
 			glVertex2f(x+m_offset[0], f(x)+m_offset[1]);
 		}
 		glEnd();
 		//glFinish();
 	}
 
-	void Window::drawPoints(const std::vector<vec2>& points, int color, size_t pointSize) {
+	void Window::drawFunctionGLSL(const std::string& expression, const std::vector<Constant>& inputConstants, int color, std::size_t lineWidth,
+								  std::size_t numInstances, const std::string& globals) {
 		glfwMakeContextCurrent(m_window);
-		glMatrixMode(GL_MODELVIEW);
-		glLoadIdentity();
-		glPointSize(pointSize);
-		auto rgb = m_palette[color];
-		glColor4f(rgb.r/255.0f,rgb.g/255.0f,rgb.b/255.0f,rgb.a/255.0f);
-
-		glBegin(GL_POINTS);
-		for(size_t i=0; i<points.size(); ++i){
-		   glVertex2f(points[i].x+m_offset[0], points[i].y+m_offset[1]);
+		if(numInstances == 0) {
+			return;
 		}
-		glEnd();
-		//glFinish();
+		auto& shader = getShader(shaders::functionVSSource(shaders::constants(inputConstants), globals, expression), shaders::colorFSSource());
+		const std::size_t numSamples = std::size_t(m_framebufferWidth) + 1;
+		glLineWidth(lineWidth*m_pixelScale);
+		shader.use([&]() {
+			auto rgb = m_palette[color];
+			shader.setUniformm("P", &m_ortho[0]);
+			shader.setUniform("offset", m_offset[0], m_offset[1]);
+			shader.setUniform("left", m_frameLeft);
+			shader.setUniform("right", m_frameRight);
+			shader.setUniform("numSamples", float(numSamples));
+			shader.setUniform("numInstances", float(numInstances));
+			shader.setUniform("color", rgb.r/255.0f, rgb.g/255.0f, rgb.b/255.0f, rgb.a/255.0f);
+			for(auto& c : inputConstants){
+				shader.setUniformv(c.first, c.second);
+			}
+			glBindVertexArray(m_emptyVao);
+			glDrawArraysInstanced(GL_LINE_STRIP, 0, GLsizei(numSamples), GLsizei(numInstances));
+			checkGLError();
+			glBindVertexArray(0);
+		});
+	}
+
+	void Window::drawPoints(const std::vector<vec2>& points, int color, size_t pointSize) {
+		drawPoints(points.data(), points.size(), color, pointSize);
 	}
 
 
@@ -626,17 +1845,20 @@ namespace mikroplot {
 		glfwMakeContextCurrent(m_window);
 		glMatrixMode(GL_MODELVIEW);
 		glLoadIdentity();
-		glLineWidth(lineWidth);
+		glLineWidth(lineWidth*m_pixelScale);
 		auto rgb = m_palette[color];
 		glColor4f(rgb.r/255.0f,rgb.g/255.0f,rgb.b/255.0f,rgb.a/255.0f);
 
+		std::vector<vec2> vertices(numSegments);
+		JobSystem::get().parallelFor("drawCircle", 0, numSegments, 8192, [&](std::size_t begin, std::size_t end) {
+			for(std::size_t i=begin; i<end; ++i) {
+				float theta = 2.0f * 3.1415926f * float(i) / float(numSegments);
+				vertices[i] = vec2(pos.x + r * cosf(theta), pos.y + r * sinf(theta));
+			}
+		});
 		glBegin(GL_LINE_LOOP);
-		for (int i=0; i<numSegments; i++)
-		{
-			float theta = 2.0f * 3.1415926f * float(i) / float(numSegments);
-			float x = r * cosf(theta);
-			float y = r * sinf(theta);
-			glVertex2f(pos.x + x + m_offset[0], pos.y + y + m_offset[1]);
+		for(const auto& v : vertices) {
+			glVertex2f(v.x + m_offset[0], v.y + m_offset[1]);
 		}
 		glEnd();
 		//glFinish();
@@ -651,21 +1873,7 @@ namespace mikroplot {
 		Shader shadeShader(shaders::shadeVSSource(), shaders::shadeFSSource(shaders::constants(inputConstants), globals, fragmentShaderMain));
 		m_shadeFbo->use([&](){
 			shadeShader.use([&](){
-				shadeShader.setUniformm("M", &m_projection[0]);
-
-				auto maxX = max(m_right, m_left);
-				auto minX = min(m_right, m_left);
-				auto maxY = max(m_top, m_bottom);
-				auto minY = min(m_top, m_bottom);
-				shadeShader.setUniformv("leftBottom", {m_left, m_bottom});
-				shadeShader.setUniformv("rightTop", {m_right, m_top});
-				shadeShader.setUniform("min", minX, minY);
-				shadeShader.setUniform("max", maxX, maxY);
-				shadeShader.setUniform("size", maxX-minX, maxY-minY);
-				for(auto& c : inputConstants){
-					shadeShader.setUniformv(c.first, c.second);
-				}
-
+				setShadeUniforms(shadeShader, inputConstants);
 				// Render screen size quad
 				quad::render(*m_ssq);
 			});
@@ -673,6 +1881,209 @@ namespace mikroplot {
 		//glFinish();
 	}
 
+	void Window::shade(ProgressiveShade& progressive, const std::vector<Constant>& inputConstants, const std::string& fragmentShaderMain,
+					   const std::string& globals, const ProgressiveOptions& options) {
+		glfwMakeContextCurrent(m_window);
+		GLint viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		const int width = std::max(1, int(viewport[2]));
+		const int height = std::max(1, int(viewport[3]));
+		const int tileSize = std::max(1, options.tileSize);
+		if(!progressive.m_fbo || progressive.m_fbo->getTexture(0)->getWidth() != width || progressive.m_fbo->getTexture(0)->getHeight() != height) {
+			progressive.m_fbo = std::make_unique<FrameBuffer>();
+			progressive.m_fbo->addColorTexture(0, std::make_shared<Texture>(width, height, false));
+			progressive.invalidate();
+		}
+		if(!progressive.m_queries[0]) {
+			glGenQueries(ProgressiveShade::NUM_QUERIES, progressive.m_queries);
+		}
+
+		// Constants and view are compared bitwise: any change starts again.
+		std::string key = fragmentShaderMain + "\n//----\n" + globals;
+		for(auto& c : inputConstants) {
+			key += "\n" + c.first + "=";
+			key.append((const char*)c.second.data(), c.second.size()*sizeof(float));
+		}
+		key.append((const char*)m_projection.data(), m_projection.size()*sizeof(float));
+		const float view[4] = {m_left, m_right, m_bottom, m_top};
+		key.append((const char*)view, sizeof(view));
+		key += std::to_string(width) + "x" + std::to_string(height) + "/" + std::to_string(tileSize);
+		if(progressive.m_key != key) {
+			progressive.m_key = key;
+			progressive.m_nextTile = 0;
+			progressive.m_order.clear();
+			for(int y=0; y<height; y += tileSize) {
+				for(int x=0; x<width; x += tileSize) {
+					progressive.m_order.push_back({x, y, std::min(tileSize, width - x), std::min(tileSize, height - y)});
+				}
+			}
+			// Center first: the interesting part of the view is usually there.
+			auto distance = [&](const std::array<int,4>& tile) {
+				const double dx = tile[0] + 0.5*tile[2] - 0.5*width;
+				const double dy = tile[1] + 0.5*tile[3] - 0.5*height;
+				return dx*dx + dy*dy;
+			};
+			std::stable_sort(progressive.m_order.begin(), progressive.m_order.end(), [&](const std::array<int,4>& a, const std::array<int,4>& b) {
+				return distance(a) < distance(b);
+			});
+			progressive.m_fbo->use([](){
+				glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+				glClear(GL_COLOR_BUFFER_BIT);
+			});
+		}
+
+		progressive.collectQueries();
+		const std::size_t remaining = progressive.m_order.size() - progressive.m_nextTile;
+		if(remaining > 0) {
+			std::size_t count = 1;
+			if(progressive.m_tileMilliseconds > 0.0) {
+				count = std::size_t(std::max(1.0, std::floor(options.budgetMilliseconds / progressive.m_tileMilliseconds)));
+			}
+			// Poster tiles are rendered once: no budget.
+			if(m_tile != std::array<float,4>{1.0f, 1.0f, 0.0f, 0.0f}) {
+				count = remaining;
+			}
+			count = std::min(count, remaining);
+			int query = -1;
+			for(int i=0; i<ProgressiveShade::NUM_QUERIES && query < 0; ++i) {
+				if(progressive.m_queryTiles[i] == 0) {
+					query = i;
+				}
+			}
+			auto& shader = getShader(shaders::shadeVSSource(), shaders::shadeFSSource(shaders::constants(inputConstants), globals, fragmentShaderMain));
+			progressive.m_fbo->use([&](){
+				if(query >= 0) {
+					glBeginQuery(GL_TIME_ELAPSED, progressive.m_queries[query]);
+				}
+				glEnable(GL_SCISSOR_TEST);
+				// Tiles are written once over cleared pixels: premultiplied color, alpha as is (not squared).
+				glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+				shader.use([&](){
+					setShadeUniforms(shader, inputConstants);
+					for(std::size_t i=0; i<count; ++i) {
+						const auto& tile = progressive.m_order[progressive.m_nextTile++];
+						glScissor(viewport[0] + tile[0], viewport[1] + tile[1], tile[2], tile[3]);
+						quad::render(*m_ssq);
+						// Submit each tile separately, so that no single command batch runs long enough to trigger a driver watchdog.
+						glFlush();
+					}
+				});
+				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				glDisable(GL_SCISSOR_TEST);
+				if(query >= 0) {
+					glEndQuery(GL_TIME_ELAPSED);
+					progressive.m_queryTiles[query] = int(count);
+				}
+			});
+			checkGLError();
+		}
+
+		// Accumulated colors are already blended once: composite as premultiplied.
+		m_shadeFbo->use([&](){
+			glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+			drawScreenSizeQuad(progressive.m_fbo->getTexture(0).get());
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		});
+	}
+
+	void Window::setShadeUniforms(Shader& shader, const std::vector<Constant>& inputConstants) {
+		shader.setUniformm("M", &m_projection[0]);
+
+		auto maxX = max(m_right, m_left);
+		auto minX = min(m_right, m_left);
+		auto maxY = max(m_top, m_bottom);
+		auto minY = min(m_top, m_bottom);
+		shader.setUniformv("leftBottom", {m_left, m_bottom});
+		shader.setUniformv("rightTop", {m_right, m_top});
+		shader.setUniform("min", minX, minY);
+		shader.setUniform("max", maxX, maxY);
+		shader.setUniform("size", maxX-minX, maxY-minY);
+		for(auto& c : inputConstants){
+			shader.setUniformv(c.first, c.second);
+		}
+	}
+
+	void Window::simulate(Feedback& feedback, int steps, const std::vector<Constant>& inputConstants, const std::string& fragmentShaderMain, const std::string& globals) {
+		glfwMakeContextCurrent(m_window);
+		prepareFeedback(feedback);
+		auto& shader = getShader(shaders::feedbackVSSource(), shaders::feedbackFSSource(shaders::constants(inputConstants), globals, fragmentShaderMain));
+		GLint viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		// Blending would mix the next state with the stale contents of the target.
+		glDisable(GL_BLEND);
+		glBindVertexArray(m_emptyVao);
+		shader.use([&]() {
+			shader.setUniform("previous", 0);
+			shader.setUniform("cells", float(feedback.m_width), float(feedback.m_height));
+			for(auto& c : inputConstants){
+				shader.setUniformv(c.first, c.second);
+			}
+			glActiveTexture(GL_TEXTURE0);
+			for(int i=0; i<steps; ++i) {
+				const int next = 1 - feedback.m_current;
+				feedback.m_fbos[next]->use([&]() {
+					glViewport(0, 0, feedback.m_width, feedback.m_height);
+					shader.setUniform("iteration", int(feedback.m_steps));
+					glBindTexture(GL_TEXTURE_2D, feedback.m_textures[feedback.m_current]->getTextureId());
+					glDrawArrays(GL_TRIANGLES, 0, 3);
+				});
+				feedback.m_current = next;
+				++feedback.m_steps;
+			}
+		});
+		checkGLError();
+		glBindVertexArray(0);
+		glEnable(GL_BLEND);
+		glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	}
+
+	void Window::drawFeedback(Feedback& feedback, const std::vector<Constant>& inputConstants, const std::string& surfaceShader, const std::string& globals) {
+		glfwMakeContextCurrent(m_window);
+		prepareFeedback(feedback);
+		auto& shader = getShader(shaders::projectionVSSource(), shaders::textureFSSource(shaders::constants(inputConstants), globals, surfaceShader));
+		shader.use([&]() {
+			shader.setUniformm("P", &m_projection[0]);
+			shader.setUniform("texture0", 0);
+			for(auto& c : inputConstants){
+				shader.setUniformv(c.first, c.second);
+			}
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, feedback.m_textures[feedback.m_current]->getTextureId());
+			quad::render(*m_ssq);
+		});
+	}
+
+	void Window::drawFeedback(Feedback& feedback, const ValueRange& range) {
+		glfwMakeContextCurrent(m_window);
+		prepareFeedback(feedback);
+		drawValueTexture(*feedback.m_textures[feedback.m_current], range);
+	}
+
+	void Window::prepareFeedback(Feedback& feedback) {
+		if(!feedback.m_textures[0]) {
+			for(int i=0; i<2; ++i) {
+				feedback.m_textures[i] = std::make_shared<Texture>(feedback.m_width, feedback.m_height, feedback.m_channels, (const float*)0);
+				if(feedback.m_wrap) {
+					glBindTexture(GL_TEXTURE_2D, feedback.m_textures[i]->getTextureId());
+					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+				}
+				feedback.m_fbos[i] = std::make_unique<FrameBuffer>();
+				feedback.m_fbos[i]->addColorTexture(0, feedback.m_textures[i]);
+			}
+			checkGLError();
+			if(!feedback.m_dirty) {
+				feedback.m_pending.assign(std::size_t(feedback.m_width)*std::size_t(feedback.m_height)*std::size_t(feedback.m_channels), 0.0f);
+				feedback.m_dirty = true;
+			}
+		}
+		if(feedback.m_dirty) {
+			feedback.m_textures[feedback.m_current]->setSubData(0, 0, feedback.m_width, feedback.m_height, feedback.m_channels, feedback.m_pending.data());
+			countUpload(feedback.m_pending.size()*sizeof(float));
+			feedback.m_pending = std::vector<float>();
+			feedback.m_dirty = false;
+		}
+	}
 
 	void Window::playSound(const std::string& fileName){
 		auto result = ma_engine_play_sound(&init->audioEngine, fileName.c_str(), NULL);
@@ -683,6 +2094,21 @@ namespace mikroplot {
 
 	}
 
+	Shader& Window::getShader(const std::string& vertexShader, const std::string& fragmentShader) {
+		auto key = vertexShader + "\n//----\n" + fragmentShader;
+		auto it = m_shaders.find(key);
+		if(it != m_shaders.end()) {
+			return *it->second;
+		}
+		auto shader = std::make_unique<Shader>(vertexShader, fragmentShader);
+		return *(m_shaders[key] = std::move(shader));
+	}
+
+	void Window::countUpload(std::size_t bytes) {
+		++m_stats.textureUploads;
+		m_stats.textureUploadBytes += bytes;
+	}
+
 	void Window::drawScreenSizeQuad(Texture* texture) {
 		glfwMakeContextCurrent(m_window);
 		m_ssqShader->use([&]() {
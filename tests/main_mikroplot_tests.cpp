@@ -0,0 +1,258 @@
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+//// MikRoPlot - C++ Plotting made easy.
+////
+//// MIT License
+////
+//// Copyright (c) 2022 Mikko Romppainen.
+////
+//// Permission is hereby granted, free of charge, to any person obtaining
+//// a copy of this software and associated documentation files (the
+//// "Software"), to deal in the Software without restriction, including
+//// without limitation the rights to use, copy, modify, merge, publish,
+//// distribute, sublicense, and/or sell copies of the Software, and to
+//// permit persons to whom the Software is furnished to do so, subject to
+//// the following conditions:
+////
+//// The above copyright notice and this permission notice shall be included
+//// in all copies or substantial portions of the Software.
+////
+//// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//// =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= ////
+#include <mikroplot/pyramid.h>
+#include <mikroplot/csv.h>
+#include <mikroplot/history.h>
+#include <mikroplot/stats.h>
+#include <mikroplot/sampling.h>
+#include <mikroplot/jobs.h>
+#include <mikroplot/pointindex.h>
+#include <mikroplot/range.h>
+#include <cmath>
+#include <limits>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+	using namespace mikroplot;
+
+	int numFailures = 0;
+
+	#define CHECK(condition) check(condition, #condition, __FILE__, __LINE__)
+
+	void check(bool condition, const char* expression, const char* file, int line) {
+		if(!condition) {
+			printf("%s:%d: CHECK(%s) failed\n", file, line, expression);
+			++numFailures;
+		}
+	}
+
+	// Query of a view past the last sample must not read past the end of the series.
+	void testPyramidQueryOutside() {
+		std::vector<float> values(1000);
+		for(std::size_t i=0; i<values.size(); ++i) {
+			values[i] = std::sin(0.01f*float(i));
+		}
+		SeriesPyramid pyramid(values.data(), values.size(), 0.0, 1.0, 8, 4);
+		pyramid.build();
+		CHECK(pyramid.query(1005, 1500, 1000).empty());
+		CHECK(pyramid.query(1005, 1500, 10).empty());
+		CHECK(pyramid.query(-500, -5, 1000).empty());
+		CHECK(pyramid.query(-500, -5, 10).empty());
+		// Partially visible views end at the last sample.
+		auto points = pyramid.query(990, 1500, 1000);
+		CHECK(!points.empty() && points.back().x == 999.0f);
+		points = pyramid.query(900, 1500, 10);
+		CHECK(!points.empty() && points.back().x <= 999.0f);
+	}
+
+	// Index saved for other data of the same length must not be loaded.
+	void testPyramidStaleIndex() {
+		const std::string fileName = "mikroplot_test.pyr";
+		std::vector<float> values(100000);
+		for(std::size_t i=0; i<values.size(); ++i) {
+			values[i] = float(i % 17);
+		}
+		SeriesPyramid pyramid(values.data(), values.size());
+		pyramid.build();
+		CHECK(pyramid.save(fileName));
+		CHECK(SeriesPyramid(values.data(), values.size()).load(fileName));
+		// Change between the sampled values is found by the full checksum only.
+		values[54321] = 100.0f;
+		SeriesPyramid changed(values.data(), values.size());
+		CHECK(!changed.load(fileName, true));
+		changed.loadOrBuild(fileName, true);
+		CHECK(SeriesPyramid(values.data(), values.size()).load(fileName, true));
+		// Regenerated data is found by the sampled hash.
+		for(std::size_t i=0; i<values.size(); ++i) {
+			values[i] = float(i % 13);
+		}
+		CHECK(!SeriesPyramid(values.data(), values.size()).load(fileName));
+		remove(fileName.c_str());
+	}
+
+	// Empty last field is NaN with and without newline at the end of input.
+	void testCsvTrailingDelimiter() {
+		for(std::string text : {"a,b,c\n1,2,3\n4,5,", "a,b,c\n1,2,3\n4,5,\n", "a,b,c\r\n1,2,3\r\n4,5,"}) {
+			auto table = CsvTable::parse(text.data(), text.size());
+			CHECK(table.getNumRows() == 2);
+			for(std::size_t i=0; i<table.getNumColumns(); ++i) {
+				CHECK(table.column(i).size() == 2);
+			}
+			CHECK(table.column("c")[0] == 3.0f);
+			CHECK(std::isnan(table.column("c")[1]));
+			CHECK(table.column("b")[1] == 5.0f);
+		}
+		// Missing fields at the end of input are NaN too.
+		const std::string text = "a,b,c\n1,2,3\n4";
+		auto table = CsvTable::parse(text.data(), text.size());
+		CHECK(table.column("a")[1] == 4.0f);
+		CHECK(std::isnan(table.column("b")[1]) && std::isnan(table.column("c")[1]));
+	}
+
+	// Timestamps round trip with delta-of-deltas at both ends of each encoding bucket.
+	void testHistoryBucketBoundaries() {
+		for(int64_t dod : {-65, -64, 63, 64, -257, -256, 255, 256, -2049, -2048, 2047, 2048, 1000000}) {
+			SeriesHistory history;
+			const std::vector<int64_t> timestamps = {0, 10000, 20000 + dod, 30000 + dod, 40000 + dod};
+			for(std::size_t i=0; i<timestamps.size(); ++i) {
+				history.append(timestamps[i], float(i));
+			}
+			auto points = history.query(-1e9, 1e9);
+			CHECK(points.size() == timestamps.size());
+			for(std::size_t i=0; i<points.size() && i<timestamps.size(); ++i) {
+				CHECK(points[i].x == float(timestamps[i]));
+				CHECK(points[i].y == float(i));
+			}
+		}
+	}
+
+	// NaN samples do not affect the statistics of the window.
+	void testStatsNaN() {
+		StatsOptions options;
+		options.windowSize = 4;
+		StreamingStats stats(options);
+		const float nan = std::numeric_limits<float>::quiet_NaN();
+		const float values[] = {1, 2, nan, 3, 4, 5, 6, nan, 7};
+		float x = 0;
+		for(float value : values) {
+			stats.add(x++, value);
+		}
+		// Window is 4, 5, 6, 7.
+		CHECK(stats.getWindowCount() == 4);
+		CHECK(std::abs(stats.getMean() - 5.5f) < 1e-5f);
+		CHECK(std::abs(stats.getVariance() - 5.0f/3.0f) < 1e-5f);
+		CHECK(stats.getMin() == 4.0f);
+		CHECK(stats.getMax() == 7.0f);
+		CHECK(!std::isnan(stats.getQuantile(0.5f)));
+		for(const auto& point : stats.getMeanLine()) {
+			CHECK(!std::isnan(point.y));
+		}
+	}
+
+	// Default options evaluate serially, and parallelFor accepts any grain.
+	void testSamplingDefaultOptions() {
+		struct Point {
+			Point(float x_, float y_) : x(x_), y(y_) {}
+			float x;
+			float y;
+		};
+		std::vector<Point> points;
+		sampling::adaptive(points, [](float x) { return std::sin(x); }, 0.0f, 10.0f, -1.0f, 1.0f, 512, 512);
+		CHECK(points.size() > 128);
+		for(std::size_t i=1; i<points.size(); ++i) {
+			CHECK(points[i-1].x < points[i].x);
+		}
+		std::size_t count = 0;
+		JobSystem::get().parallelFor("test", 0, 1000, ~std::size_t(0), [&](std::size_t begin, std::size_t end) {
+			count += end - begin;
+		});
+		CHECK(count == 1000);
+	}
+
+	// Appended points, also outside the grid bounds, are found as by linear search.
+	void testPointIndexAppend() {
+		std::vector<vec2> points;
+		for(int i=0; i<20000; ++i) {
+			points.push_back(vec2(std::sin(0.37f*float(i)), std::cos(0.91f*float(i))));
+		}
+		PointIndex index(points);
+		for(int i=0; i<2000; ++i) {
+			const vec2 p(3.0f*std::sin(1.3f*float(i)), 3.0f*std::cos(0.7f*float(i)));
+			index.append(p);
+			points.push_back(p);
+		}
+		for(int q=0; q<200; ++q) {
+			const vec2 position(2.5f*std::sin(2.1f*float(q)), 2.5f*std::cos(1.7f*float(q)));
+			float bestDistance = INFINITY;
+			for(const auto& p : points) {
+				bestDistance = std::min(bestDistance, (p.x-position.x)*(p.x-position.x) + (p.y-position.y)*(p.y-position.y));
+			}
+			const std::ptrdiff_t nearest = index.nearest(position);
+			CHECK(nearest >= 0);
+			if(nearest >= 0) {
+				const vec2 p = points[std::size_t(nearest)];
+				CHECK((p.x-position.x)*(p.x-position.x) + (p.y-position.y)*(p.y-position.y) == bestDistance);
+			}
+		}
+		std::vector<std::size_t> result;
+		index.query(0.5f, 2.5f, -2.0f, 1.5f, result);
+		std::vector<std::size_t> expected;
+		for(std::size_t i=0; i<points.size(); ++i) {
+			if(points[i].x >= 0.5f && points[i].x <= 2.5f && points[i].y >= -2.0f && points[i].y <= 1.5f) {
+				expected.push_back(i);
+			}
+		}
+		CHECK(result == expected);
+	}
+
+	// Range of several arrays is the range of the arrays concatenated.
+	void testRangeOfArrays() {
+		std::vector< std::vector<float> > arrays = {std::vector<float>(70000), {}, std::vector<float>(3), std::vector<float>(150000)};
+		std::vector<float> all;
+		std::vector< std::pair<const float*, std::size_t> > spans;
+		float x = 0.0f;
+		for(auto& values : arrays) {
+			for(auto& value : values) {
+				x += 0.001f;
+				value = std::sin(x) * x;
+			}
+			all.insert(all.end(), values.begin(), values.end());
+			spans.push_back({values.data(), values.size()});
+		}
+		for(auto mode : {AutoRange::MIN_MAX, AutoRange::EQUALIZE}) {
+			RangeOptions options;
+			options.mode = mode;
+			const auto expected = range::compute(all.data(), all.size(), options);
+			const auto range = range::compute(spans, options);
+			CHECK(range.min == expected.min);
+			CHECK(range.max == expected.max);
+			CHECK(range.lut == expected.lut);
+		}
+	}
+}
+
+int main() {
+	const std::vector< std::pair<const char*, std::function<void()> > > tests = {
+		{"pyramid query outside", testPyramidQueryOutside},
+		{"pyramid stale index", testPyramidStaleIndex},
+		{"csv trailing delimiter", testCsvTrailingDelimiter},
+		{"history bucket boundaries", testHistoryBucketBoundaries},
+		{"stats NaN", testStatsNaN},
+		{"sampling default options", testSamplingDefaultOptions},
+		{"point index append", testPointIndexAppend},
+		{"range of arrays", testRangeOfArrays},
+	};
+	for(const auto& test : tests) {
+		const int failures = numFailures;
+		test.second();
+		printf("%s: %s\n", numFailures == failures ? "PASS" : "FAIL", test.first);
+	}
+	return numFailures == 0 ? 0 : 1;
+}